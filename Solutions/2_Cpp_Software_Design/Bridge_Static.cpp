@@ -132,18 +132,91 @@ class C;
 class E;
 
 
-//---- <X.h> --------------------------------------------------------------------------------------
+//---- <FastPimpl.h> ------------------------------------------------------------------------------
 
+#include <array>
+#include <bit>
 #include <cstddef>
-#include <iosfwd>
 #include <memory>
+#include <new>
 #include <type_traits>
+#include <utility>
+
+// In-class storage for the implementation details of a class (the "Fast Pimpl Idiom"). 'Impl'
+// may be incomplete, but has to be complete wherever a constructor, the destructor, or an
+// assignment operator of 'fast_pimpl' is instantiated. In case 'Size' or 'Align' are insufficient,
+// the diagnostic contains the required size and alignment ('RequiredSize' and 'RequiredAlign').
+template< typename Impl, size_t Size, size_t Align = alignof(std::max_align_t) >
+class fast_pimpl
+{
+   static_assert( std::has_single_bit( Align ), "The alignment must be a power of two" );
+
+ public:
+   template< typename... Args >
+      requires ( sizeof...(Args) != 1UL || !( std::is_same_v<std::remove_cvref_t<Args>,fast_pimpl> && ... ) )
+   explicit fast_pimpl( Args&&... args )
+   {
+      validate<sizeof(Impl),alignof(Impl)>();
+      std::construct_at( get(), std::forward<Args>(args)... );
+   }
+
+   ~fast_pimpl()
+   {
+      std::destroy_at( get() );
+   }
+
+   fast_pimpl( fast_pimpl const& other )
+   {
+      validate<sizeof(Impl),alignof(Impl)>();
+      std::construct_at( get(), *other );
+   }
+
+   fast_pimpl& operator=( fast_pimpl const& other )
+   {
+      **this = *other;
+      return *this;
+   }
+
+   fast_pimpl( fast_pimpl&& other ) noexcept( std::is_nothrow_move_constructible_v<Impl> )
+   {
+      validate<sizeof(Impl),alignof(Impl)>();
+      std::construct_at( get(), std::move(*other) );
+   }
+
+   fast_pimpl& operator=( fast_pimpl&& other ) noexcept( std::is_nothrow_move_assignable_v<Impl> )
+   {
+      **this = std::move(*other);
+      return *this;
+   }
+
+   Impl*       get()       noexcept { return std::launder( reinterpret_cast<Impl*>( buffer_.data() ) ); }
+   Impl const* get() const noexcept { return std::launder( reinterpret_cast<Impl const*>( buffer_.data() ) ); }
+
+   Impl&       operator*()       noexcept { return *get(); }
+   Impl const& operator*() const noexcept { return *get(); }
+
+   Impl*       operator->()       noexcept { return get(); }
+   Impl const* operator->() const noexcept { return get(); }
+
+ private:
+   template< size_t RequiredSize, size_t RequiredAlign >
+   static constexpr void validate() noexcept
+   {
+      static_assert( RequiredSize <= Size, "The size of the buffer is insufficient: Increase 'Size' to 'RequiredSize'" );
+      static_assert( RequiredAlign <= Align, "The alignment of the buffer is insufficient: Increase 'Align' to 'RequiredAlign'" );
+   }
+
+   alignas(Align) std::array<std::byte,Size> buffer_;  // Not initialized!
+};
+
 
-#if _MSC_VER && !__INTEL_COMPILER
-#  define _ENABLE_EXTENDED_ALIGNED_STORAGE
-#endif
+//---- <X.h> --------------------------------------------------------------------------------------
+
+#include <cstddef>
+#include <iosfwd>
 
 //#include <A.h>
+//#include <FastPimpl.h>
 //#include <Fwd.h>
 
 class X : public A
@@ -161,13 +234,10 @@ class X : public A
  private:
    struct XImpl;
 
-   XImpl& pimpl() { return *reinterpret_cast<XImpl*>(&buffer_); }
-
-   static constexpr size_t buffersize  = 100;
+   static constexpr size_t buffersize  = 104;
    static constexpr size_t bufferalign =  16;
 
-   using Buffer = std::aligned_storage<buffersize,bufferalign>::type;
-   Buffer buffer_;
+   fast_pimpl<XImpl,buffersize,bufferalign> pimpl_;
 };
 
 
@@ -204,12 +274,8 @@ struct X::XImpl
 
 X::X( const C& c )
    : A{}
-{
-   static_assert( sizeof(XImpl) <= sizeof(buffer_) );
-   static_assert( alignof(XImpl) <= alignof(Buffer) );
-
-   new (&buffer_) XImpl{ c };
-}
+   , pimpl_{ c }
+{}
 
 X::~X() = default;
 
@@ -220,13 +286,13 @@ B X::f( int, char* )
 
 C X::f( int, C )
 {
-   assert( !pimpl().clist_.empty() );
-   return *begin(pimpl().clist_);
+   assert( !pimpl_->clist_.empty() );
+   return *begin(pimpl_->clist_);
 }
 
 C& X::g( B )
 {
-   return pimpl().d_;
+   return pimpl_->d_;
 }
 
 E X::h( E )
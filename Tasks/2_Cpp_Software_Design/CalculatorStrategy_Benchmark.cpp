@@ -0,0 +1,326 @@
+/**************************************************************************************************
+*
+* \file CalculatorStrategy_Benchmark.cpp
+* \brief C++ Training - Benchmark for the Strategy Design Pattern (Calculator)
+*
+* Copyright (C) 2015-2023 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#define BENCHMARK_STD_FUNCTION_SOLUTION 1
+#define BENCHMARK_POLICY_SOLUTION 1
+#define BENCHMARK_VARIANT_SOLUTION 1
+
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <span>
+#include <sstream>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+
+//---- Input --------------------------------------------------------------------------------------
+
+constexpr size_t N( 10000000UL );  // Number of computed values
+constexpr size_t average_block_size( 1000UL );  // Average number of values between two switches
+
+
+std::vector<int> generate_values( unsigned int seed )
+{
+   std::mt19937 rng{ seed };
+   std::uniform_int_distribution<int> value_dist( -100, 100 );
+
+   std::vector<int> values( N );
+   for( auto& value : values ) {
+      value = value_dist(rng);
+   }
+   return values;
+}
+
+
+// A range of values, which is computed with the same strategy
+struct Block
+{
+   enum Kind : std::uint8_t { plus, minus };
+
+   Kind kind{};
+   size_t begin{};
+   size_t end{};
+};
+
+// Splits the values into blocks of random size and alternates between addition and subtraction
+std::vector<Block> generate_blocks( unsigned int seed )
+{
+   std::mt19937 rng{ seed };
+   std::uniform_int_distribution<size_t> size_dist( 1UL, 2UL*average_block_size );
+
+   std::vector<Block> blocks;
+   for( size_t begin=0UL; begin<N; ) {
+      size_t const end( std::min( begin + size_dist(rng), N ) );
+      Block::Kind const kind( blocks.size() % 2UL == 0UL ? Block::plus : Block::minus );
+      blocks.push_back( Block{ kind, begin, end } );
+      begin = end;
+   }
+   return blocks;
+}
+
+
+#if BENCHMARK_STD_FUNCTION_SOLUTION
+namespace std_function_solution {
+
+   // The calculator of 'Calculator_Strategy.cpp'
+   class Calculator
+   {
+    public:
+      using Strategy = std::function<int(int,int)>;
+
+      Calculator() = default;
+      explicit Calculator( Strategy strategy )
+         : strategy_{ std::move(strategy) }
+      {}
+
+      void set( Strategy strategy ) { strategy_ = std::move(strategy); }
+
+      int result() const { return current_; }
+      void reset() { current_ = 0; strategy_ = std::plus<>{}; }
+
+      void compute( int value ) { current_ = strategy_( current_, value ); }
+
+    private:
+      int current_{};
+      Strategy strategy_{ std::plus<>{} };
+   };
+
+} // namespace std_function_solution
+#endif
+
+
+#if BENCHMARK_POLICY_SOLUTION
+namespace policy_solution {
+
+   template< typename S >
+   concept CalculatorStrategy = std::is_invocable_r_v<int,S const&,int,int>;
+
+   // The strategy is bound at compile time and can therefore be inlined into 'compute()'. Stateless
+   // strategies (as for instance 'std::plus<>') don't occupy any memory. This is the right choice
+   // for all calculators that never change their strategy after construction.
+   template< CalculatorStrategy Strategy = std::plus<> >
+   class Calculator
+   {
+    public:
+      Calculator() = default;
+      explicit Calculator( Strategy strategy )
+         : strategy_{ std::move(strategy) }
+      {}
+
+      int result() const { return current_; }
+      void reset() { current_ = 0; }
+
+      void compute( int value ) { current_ = strategy_( current_, value ); }
+
+      // Computes all given values. The intermediate results are kept in a local variable, which
+      // (in contrast to the data member) cannot alias the values.
+      void compute( std::span<int const> values )
+      {
+         int current( current_ );
+         for( int value : values ) {
+            current = strategy_( current, value );
+         }
+         current_ = current;
+      }
+
+    private:
+      int current_{};
+      [[no_unique_address]] Strategy strategy_{};
+   };
+
+} // namespace policy_solution
+#endif
+
+
+#if BENCHMARK_VARIANT_SOLUTION
+namespace variant_solution {
+
+   // The closed set of strategies, which can be selected at runtime. Adding a strategy requires
+   // to extend this list, but no change of the calculator.
+   using Strategy = std::variant< std::plus<>, std::minus<>, std::multiplies<> >;
+
+   class Calculator
+   {
+    public:
+      Calculator() = default;
+      explicit Calculator( Strategy strategy )
+         : strategy_{ std::move(strategy) }
+      {}
+
+      void set( Strategy strategy ) { strategy_ = std::move(strategy); }
+
+      int result() const { return current_; }
+      void reset() { current_ = 0; strategy_ = std::plus<>{}; }
+
+      void compute( int value )
+      {
+         current_ = std::visit( [&]( auto const& strategy ){ return strategy( current_, value ); }, strategy_ );
+      }
+
+      // Dispatches once for all given values, which are then computed with the inlined strategy
+      void compute( std::span<int const> values )
+      {
+         current_ = std::visit( [&]( auto const& strategy ){
+            int current( current_ );
+            for( int value : values ) {
+               current = strategy( current, value );
+            }
+            return current;
+         }, strategy_ );
+      }
+
+    private:
+      int current_{};
+      Strategy strategy_{};
+   };
+
+} // namespace variant_solution
+#endif
+
+
+//---- Benchmark ----------------------------------------------------------------------------------
+
+// Computes the values one by one
+template< typename Calculator >
+void compute_each( Calculator& calculator, std::span<int const> values )
+{
+   for( int value : values ) {
+      calculator.compute( value );
+   }
+}
+
+// Computes all values at once
+template< typename Calculator >
+void compute_all( Calculator& calculator, std::span<int const> values )
+{
+   calculator.compute( values );
+}
+
+// Computes the blocks of values with alternating strategies, which are selected at runtime
+template< typename Calculator, typename Compute >
+void compute_blocks( Calculator& calculator, std::span<int const> values
+                   , std::vector<Block> const& blocks, Compute compute )
+{
+   for( auto const& block : blocks )
+   {
+      if( block.kind == Block::plus ) calculator.set( std::plus<>{} );
+      else calculator.set( std::minus<>{} );
+
+      compute( calculator, values.subspan( block.begin, block.end - block.begin ) );
+   }
+}
+
+
+template< typename Run >
+void benchmark( char const* label, Run run )
+{
+   std::chrono::time_point<std::chrono::high_resolution_clock> start, end;
+   start = std::chrono::high_resolution_clock::now();
+
+   int const result( run() );
+
+   end = std::chrono::high_resolution_clock::now();
+   std::chrono::duration<double> const elapsedTime( end - start );
+   double const seconds( elapsedTime.count() );
+
+   // The formatting flags are set on a local stream to leave 'std::cout' unchanged
+   std::ostringstream os;
+   os << " " << std::left << std::setw(36) << label << ": " << seconds << "s"
+      << "  (" << std::setprecision(4) << N/seconds/1E6 << "M ops/s"
+      << ", result = " << result << ")\n";
+   std::cout << os.str();
+}
+
+
+int main()
+{
+   std::random_device rd{};
+   unsigned int const seed( rd() );
+
+   std::vector<int> const values( generate_values( seed ) );
+   std::vector<Block> const blocks( generate_blocks( seed+1U ) );
+
+   auto const each = []( auto& calculator, std::span<int const> v ){ compute_each( calculator, v ); };
+   auto const all  = []( auto& calculator, std::span<int const> v ){ compute_all( calculator, v ); };
+
+   std::cout << "\n Fixed strategy (std::plus<>)\n";
+
+#if BENCHMARK_STD_FUNCTION_SOLUTION
+   benchmark( "std::function", [&](){
+      std_function_solution::Calculator calculator{ std::plus<>{} };
+      compute_each( calculator, values );
+      return calculator.result();
+   } );
+#endif
+
+#if BENCHMARK_POLICY_SOLUTION
+   benchmark( "Policy (per value)", [&](){
+      policy_solution::Calculator<std::plus<>> calculator{};
+      compute_each( calculator, values );
+      return calculator.result();
+   } );
+   benchmark( "Policy (span)", [&](){
+      policy_solution::Calculator<std::plus<>> calculator{};
+      compute_all( calculator, values );
+      return calculator.result();
+   } );
+#endif
+
+#if BENCHMARK_VARIANT_SOLUTION
+   benchmark( "std::variant (per value)", [&](){
+      variant_solution::Calculator calculator{ std::plus<>{} };
+      compute_each( calculator, values );
+      return calculator.result();
+   } );
+   benchmark( "std::variant (span)", [&](){
+      variant_solution::Calculator calculator{ std::plus<>{} };
+      compute_all( calculator, values );
+      return calculator.result();
+   } );
+#endif
+
+   std::cout << "\n Switching strategies (" << blocks.size() << " switches)\n";
+
+#if BENCHMARK_STD_FUNCTION_SOLUTION
+   benchmark( "std::function", [&](){
+      std_function_solution::Calculator calculator{};
+      compute_blocks( calculator, values, blocks, each );
+      return calculator.result();
+   } );
+#endif
+
+#if BENCHMARK_VARIANT_SOLUTION
+   benchmark( "std::variant (per value)", [&](){
+      variant_solution::Calculator calculator{};
+      compute_blocks( calculator, values, blocks, each );
+      return calculator.result();
+   } );
+   benchmark( "std::variant (span)", [&](){
+      variant_solution::Calculator calculator{};
+      compute_blocks( calculator, values, blocks, all );
+      return calculator.result();
+   } );
+#endif
+
+   std::cout << std::endl;
+
+   return EXIT_SUCCESS;
+}
@@ -0,0 +1,879 @@
+/**************************************************************************************************
+*
+* \file Calculator_Benchmark.cpp
+* \brief C++ Training - Benchmark for the Command Design Pattern (Calculator)
+*
+* Copyright (C) 2015-2023 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#define BENCHMARK_COMMAND_SOLUTION 1
+#define BENCHMARK_INLINE_COMMAND_SOLUTION 1
+#define BENCHMARK_BATCH_COMMAND_SOLUTION 1
+#define BENCHMARK_CHECKPOINTED_COMMAND_SOLUTION 1
+
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <span>
+#include <stack>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+
+//---- Operation stream ---------------------------------------------------------------------------
+
+// The input of all solutions: A random sequence of additions, subtractions, and undo operations
+struct Operation
+{
+   enum Kind : std::uint8_t { add, subtract, undo };
+
+   Kind kind{};
+   int operand{};
+};
+
+constexpr size_t N( 10000000UL );  // Number of operations
+
+
+std::vector<Operation> generate_operations( unsigned int seed )
+{
+   std::mt19937 rng{ seed };
+   std::uniform_int_distribution<int> kind_dist( 1, 20 );
+   std::uniform_int_distribution<int> operand_dist( 1, 100 );
+
+   std::vector<Operation> operations;
+   operations.reserve( N );
+
+   while( operations.size() < N )
+   {
+      int const random_value( kind_dist(rng) );
+
+      if( random_value <= 9 ) {
+         operations.push_back( Operation{ Operation::add, operand_dist(rng) } );
+      }
+      else if( random_value <= 18 ) {
+         operations.push_back( Operation{ Operation::subtract, operand_dist(rng) } );
+      }
+      else {
+         operations.push_back( Operation{ Operation::undo, 0 } );
+      }
+   }
+
+   return operations;
+}
+
+
+#if BENCHMARK_COMMAND_SOLUTION
+namespace command_solution {
+
+   class CalculatorCommand
+   {
+    public:
+      virtual ~CalculatorCommand() = default;
+
+      virtual int execute( int i ) const = 0;
+      virtual int undo( int i ) const = 0;
+   };
+
+   class Addition : public CalculatorCommand
+   {
+    public:
+      explicit Addition( int operand ) : operand_(operand) {}
+
+      int execute( int i ) const override { return i + operand_; }
+      int undo( int i ) const override { return i - operand_; }
+
+    private:
+      int operand_{};
+   };
+
+   class Subtraction : public CalculatorCommand
+   {
+    public:
+      explicit Subtraction( int operand ) : operand_(operand) {}
+
+      int execute( int i ) const override { return i - operand_; }
+      int undo( int i ) const override { return i + operand_; }
+
+    private:
+      int operand_{};
+   };
+
+   // The undo is exact for any non-zero operand, as long as 'execute()' does not overflow
+   class Multiplication : public CalculatorCommand
+   {
+    public:
+      explicit Multiplication( int operand ) : operand_(operand) {}
+
+      int execute( int i ) const override { return i * operand_; }
+      int undo( int i ) const override { return i / operand_; }
+
+    private:
+      int operand_{};
+   };
+
+   class Calculator
+   {
+    public:
+      void compute( std::unique_ptr<CalculatorCommand> command )
+      {
+         current_ = command->execute( current_ );
+         stack_.push( std::move(command) );
+      }
+
+      void undoLast()
+      {
+         if( stack_.empty() ) return;
+
+         auto command = std::move(stack_.top());
+         stack_.pop();
+
+         current_ = command->undo(current_);
+      }
+
+      int result() const { return current_; }
+
+    private:
+      using CommandStack = std::stack<std::unique_ptr<CalculatorCommand>>;
+
+      int current_{};
+      CommandStack stack_;
+   };
+
+   void apply( Calculator& calculator, Operation const& op )
+   {
+      switch( op.kind ) {
+         case Operation::add:      calculator.compute( std::make_unique<Addition>( op.operand ) ); break;
+         case Operation::subtract: calculator.compute( std::make_unique<Subtraction>( op.operand ) ); break;
+         case Operation::undo:     calculator.undoLast(); break;
+      }
+   }
+
+} // namespace command_solution
+#endif
+
+
+#if BENCHMARK_INLINE_COMMAND_SOLUTION
+namespace inline_command_solution {
+
+   // Commands are value types without a common base class
+   class Addition
+   {
+    public:
+      explicit Addition( int operand ) : operand_(operand) {}
+
+      int execute( int i ) const { return i + operand_; }
+      int undo( int i ) const { return i - operand_; }
+
+    private:
+      int operand_{};
+   };
+
+   class Subtraction
+   {
+    public:
+      explicit Subtraction( int operand ) : operand_(operand) {}
+
+      int execute( int i ) const { return i - operand_; }
+      int undo( int i ) const { return i + operand_; }
+
+    private:
+      int operand_{};
+   };
+
+   using CalculatorCommand = std::variant<Addition,Subtraction>;
+
+
+   // A bounded undo log, which stores the commands by value in a ring buffer. The buffer is
+   // allocated once, pushing and popping commands never allocates or deallocates. In case the
+   // log is full, the oldest command is overwritten.
+   template< typename Command >
+   class UndoLog
+   {
+      static_assert( std::is_trivially_copyable_v<Command> );
+
+    public:
+      explicit UndoLog( size_t capacity )
+         : capacity_( std::bit_ceil( std::max( capacity, size_t{1} ) ) )
+         , buffer_( std::allocator<Command>{}.allocate( capacity_ ) )
+      {}
+
+      ~UndoLog() { std::allocator<Command>{}.deallocate( buffer_, capacity_ ); }
+
+      UndoLog( UndoLog const& ) = delete;
+      UndoLog& operator=( UndoLog const& ) = delete;
+
+      bool empty() const { return size_ == 0UL; }
+      size_t size() const { return size_; }
+      size_t capacity() const { return capacity_; }
+
+      void push( Command const& command )
+      {
+         std::construct_at( buffer_ + ( head_ & (capacity_-1UL) ), command );
+         ++head_;
+         size_ = std::min( size_+1UL, capacity_ );
+      }
+
+      Command const& top() const { return buffer_[ (head_-1UL) & (capacity_-1UL) ]; }
+
+      void pop()
+      {
+         --head_;
+         --size_;
+      }
+
+      void clear() { head_ = size_ = 0UL; }
+
+    private:
+      size_t capacity_{};
+      Command* buffer_{};
+      size_t head_{};  // Position of the next command, wraps around
+      size_t size_{};
+   };
+
+
+   class Calculator
+   {
+    public:
+      explicit Calculator( size_t undo_depth ) : log_( undo_depth ) {}
+
+      void compute( CalculatorCommand const& command )
+      {
+         current_ = std::visit( [i=current_]( auto const& c ){ return c.execute( i ); }, command );
+         log_.push( command );
+      }
+
+      void undoLast()
+      {
+         if( log_.empty() ) return;
+
+         current_ = std::visit( [i=current_]( auto const& c ){ return c.undo( i ); }, log_.top() );
+         log_.pop();
+      }
+
+      int result() const { return current_; }
+
+      void reset()
+      {
+         current_ = 0;
+         log_.clear();
+      }
+
+    private:
+      int current_{};
+      UndoLog<CalculatorCommand> log_;
+   };
+
+   void apply( Calculator& calculator, Operation const& op )
+   {
+      switch( op.kind ) {
+         case Operation::add:      calculator.compute( Addition{ op.operand } ); break;
+         case Operation::subtract: calculator.compute( Subtraction{ op.operand } ); break;
+         case Operation::undo:     calculator.undoLast(); break;
+      }
+   }
+
+} // namespace inline_command_solution
+#endif
+
+
+//---- Compact commands ---------------------------------------------------------------------------
+
+namespace compact_commands {
+
+   // A compact, trivially copyable command, which is shared by the batch and the checkpointed
+   // command solution. Since both calculators undo commands via their own logs, the commands
+   // don't require an 'undo()' function, which also enables non-invertible commands. The
+   // concrete commands below only select the operation.
+   class CalculatorCommand
+   {
+    public:
+      enum Opcode : std::uint8_t { addition, subtraction, multiplication };
+
+      CalculatorCommand( Opcode opcode, int operand ) : opcode_(opcode), operand_(operand) {}
+
+      Opcode opcode() const { return opcode_; }
+      int operand() const { return operand_; }
+
+      // Selects the operation without a branch on the (unpredictable) opcode
+      int execute( int i ) const
+      {
+         int const sign( 1 - 2*static_cast<int>( opcode_ == subtraction ) );
+         return opcode_ == multiplication ? i * operand_ : i + sign*operand_;
+      }
+
+    private:
+      Opcode opcode_{};
+      int operand_{};
+   };
+
+   struct Addition : public CalculatorCommand
+   {
+      explicit Addition( int operand ) : CalculatorCommand( addition, operand ) {}
+   };
+
+   struct Subtraction : public CalculatorCommand
+   {
+      explicit Subtraction( int operand ) : CalculatorCommand( subtraction, operand ) {}
+   };
+
+   struct Multiplication : public CalculatorCommand
+   {
+      explicit Multiplication( int operand ) : CalculatorCommand( multiplication, operand ) {}
+   };
+
+
+   // Evaluates the given commands, starting from 'value'. Every run of consecutive additions
+   // and subtractions is fused into a single addition. The sum is accumulated in a wider type,
+   // i.e. it does not overflow in case the sequential evaluation does not overflow. In contrast,
+   // multiplications are applied one by one, since a fused product might overflow even though
+   // the sequential evaluation does not (for instance for a start value of 0).
+   int evaluate( int value, std::span<CalculatorCommand const> commands )
+   {
+      size_t i( 0UL );
+      size_t const n( commands.size() );
+
+      while( i < n )
+      {
+         if( commands[i].opcode() == CalculatorCommand::multiplication ) {
+            value *= commands[i].operand();
+            ++i;
+         }
+         else {
+            long long sum( 0 );
+            for( ; i<n && commands[i].opcode() != CalculatorCommand::multiplication; ++i ) {
+               sum += commands[i].opcode() == CalculatorCommand::addition ? commands[i].operand() : -commands[i].operand();
+            }
+            value = static_cast<int>( value + sum );
+         }
+      }
+
+      return value;
+   }
+
+} // namespace compact_commands
+
+
+#if BENCHMARK_BATCH_COMMAND_SOLUTION
+namespace batch_command_solution {
+
+   using compact_commands::CalculatorCommand;
+   using compact_commands::Addition;
+   using compact_commands::Subtraction;
+   using compact_commands::Multiplication;
+   using compact_commands::evaluate;
+
+
+   class Calculator
+   {
+    public:
+      explicit Calculator( size_t capacity )
+      {
+         commands_.reserve( capacity );
+      }
+
+      // Executes all given commands at once. Every command can still be undone individually.
+      void compute( std::span<CalculatorCommand const> commands )
+      {
+         if( commands.empty() ) return;
+
+         batches_.push_back( Batch{ current_, commands.size() } );
+         commands_.insert( commands_.end(), commands.begin(), commands.end() );
+         current_ = evaluate( current_, commands );
+      }
+
+      void compute( CalculatorCommand const& command )
+      {
+         compute( std::span<CalculatorCommand const>( &command, 1UL ) );
+      }
+
+      // Reverts the last command. Additions and subtractions are inverted directly, a
+      // multiplication is reverted by re-evaluating the remaining commands of its batch.
+      void undoLast()
+      {
+         if( batches_.empty() ) return;
+
+         Batch& batch( batches_.back() );
+         CalculatorCommand const command( commands_.back() );
+         commands_.pop_back();
+
+         if( --batch.size == 0UL ) {
+            current_ = batch.start;
+            batches_.pop_back();
+         }
+         else if( command.opcode() != CalculatorCommand::multiplication ) {
+            current_ -= command.opcode() == CalculatorCommand::addition ? command.operand() : -command.operand();
+         }
+         else {
+            current_ = evaluate( batch.start, std::span<CalculatorCommand const>( commands_ ).last( batch.size ) );
+         }
+      }
+
+      int result() const { return current_; }
+
+      void reset()
+      {
+         current_ = 0;
+         commands_.clear();
+         batches_.clear();
+      }
+
+    private:
+      // The per-batch undo log: the value before the batch and the number of its commands
+      struct Batch
+      {
+         int start{};
+         size_t size{};
+      };
+
+      int current_{};
+      std::vector<CalculatorCommand> commands_;
+      std::vector<Batch> batches_;
+   };
+
+   // Replays the operations in batches of consecutive commands, which are interrupted by undos
+   void replay( Calculator& calculator, std::vector<Operation> const& operations )
+   {
+      constexpr size_t batch_size( 64UL );
+
+      std::vector<CalculatorCommand> batch;
+      batch.reserve( batch_size );
+
+      auto const flush = [&](){
+         calculator.compute( batch );
+         batch.clear();
+      };
+
+      for( auto const& op : operations )
+      {
+         if( op.kind == Operation::undo ) {
+            flush();
+            calculator.undoLast();
+            continue;
+         }
+
+         // Branch-free selection of the command
+         batch.emplace_back( op.kind == Operation::add ? CalculatorCommand::addition : CalculatorCommand::subtraction
+                           , op.operand );
+         if( batch.size() == batch_size ) flush();
+      }
+
+      flush();
+   }
+
+} // namespace batch_command_solution
+#endif
+
+
+#if BENCHMARK_COMMAND_SOLUTION && BENCHMARK_BATCH_COMMAND_SOLUTION
+// Compares the batch calculator with the command solution on a random sequence of batches and
+// undos, which mixes additions, subtractions, and multiplications. Multiplications are only
+// issued as long as the result is small, i.e. none of the two solutions overflows.
+bool check_batch_command_solution( unsigned int seed )
+{
+   std::mt19937 rng{ seed };
+   std::uniform_int_distribution<int> kind_dist( 1, 4 );
+   std::uniform_int_distribution<int> operand_dist( 1, 3 );
+   std::uniform_int_distribution<size_t> count_dist( 1UL, 8UL );
+
+   command_solution::Calculator reference{};
+   batch_command_solution::Calculator calculator{ 1024UL };
+   std::vector<batch_command_solution::CalculatorCommand> batch;
+
+   for( size_t step=0UL; step<10000UL; ++step )
+   {
+      size_t const count( count_dist(rng) );
+
+      if( step % 3UL == 2UL ) {
+         for( size_t i=0UL; i<count; ++i ) {
+            reference.undoLast();
+            calculator.undoLast();
+            if( calculator.result() != reference.result() ) return false;
+         }
+         continue;
+      }
+
+      batch.clear();
+      for( size_t i=0UL; i<count; ++i )
+      {
+         int const kind( kind_dist(rng) );
+         int const operand( operand_dist(rng) );
+
+         if( kind <= 2 && std::abs( reference.result() ) < 100000 ) {
+            int const factor( kind == 1 ? operand : -operand );
+            reference.compute( std::make_unique<command_solution::Multiplication>( factor ) );
+            batch.push_back( batch_command_solution::Multiplication{ factor } );
+         }
+         else if( kind % 2 == 1 ) {
+            reference.compute( std::make_unique<command_solution::Addition>( operand ) );
+            batch.push_back( batch_command_solution::Addition{ operand } );
+         }
+         else {
+            reference.compute( std::make_unique<command_solution::Subtraction>( operand ) );
+            batch.push_back( batch_command_solution::Subtraction{ operand } );
+         }
+      }
+
+      calculator.compute( batch );
+      if( calculator.result() != reference.result() ) return false;
+   }
+
+   return true;
+}
+#endif
+
+
+#if BENCHMARK_CHECKPOINTED_COMMAND_SOLUTION
+namespace checkpointed_command_solution {
+
+   using compact_commands::CalculatorCommand;
+   using compact_commands::Addition;
+   using compact_commands::Subtraction;
+   using compact_commands::Multiplication;
+   using compact_commands::evaluate;
+
+
+   // The calculator keeps the complete command history and a snapshot of the result after every
+   // 'interval' commands (a power of two). Any point of the history can be restored from the
+   // preceding snapshot by replaying at most 'interval-1' commands. In case the snapshots exceed
+   // the memory budget, the interval is doubled and every other snapshot is dropped, i.e. the
+   // cost of a jump grows with the length of the history divided by the budget.
+   class Calculator
+   {
+    public:
+      explicit Calculator( size_t snapshot_budget = 1024UL*1024UL, size_t interval = 16UL )
+         : shift_( std::countr_zero( std::bit_ceil( std::max( interval, size_t{1} ) ) ) )
+         , max_snapshots_( std::max( snapshot_budget / sizeof(int), size_t{2} ) )
+      {
+         snapshots_.push_back( current_ );
+      }
+
+      void compute( CalculatorCommand const& command )
+      {
+         truncate();
+
+         current_ = command.execute( current_ );
+         commands_.push_back( command );
+         ++position_;
+
+         if( ( position_ & ( interval()-1UL ) ) == 0UL ) {
+            snapshots_.push_back( current_ );
+            if( snapshots_.size() > max_snapshots_ ) thin();
+         }
+      }
+
+      // Reverts the last command. Additions and subtractions are inverted directly, all other
+      // commands are reverted via the preceding snapshot.
+      void undoLast()
+      {
+         if( position_ == 0UL ) return;
+
+         CalculatorCommand const& command( commands_[position_-1UL] );
+
+         if( command.opcode() != CalculatorCommand::multiplication ) {
+            current_ -= command.opcode() == CalculatorCommand::addition ? command.operand() : -command.operand();
+            --position_;
+         }
+         else {
+            jumpTo( position_-1UL );
+         }
+      }
+
+      // Re-executes the last undone command
+      void redo()
+      {
+         if( position_ == commands_.size() ) return;
+
+         current_ = commands_[position_].execute( current_ );
+         ++position_;
+      }
+
+      // Restores the result after the first 'index' commands of the history (in both directions)
+      void jumpTo( size_t index )
+      {
+         index = std::min( index, commands_.size() );
+
+         size_t const snapshot( index >> shift_ );
+         size_t const first( snapshot << shift_ );
+
+         current_ = evaluate( snapshots_[snapshot]
+                            , std::span<CalculatorCommand const>( commands_ ).subspan( first, index-first ) );
+         position_ = index;
+      }
+
+      void reserve( size_t capacity ) { commands_.reserve( capacity ); }
+
+      size_t position() const { return position_; }
+      size_t history() const { return commands_.size(); }
+      size_t interval() const { return size_t{1} << shift_; }
+
+      int result() const { return current_; }
+
+      void reset()
+      {
+         current_ = 0;
+         position_ = 0UL;
+         commands_.clear();
+         snapshots_.assign( 1UL, current_ );
+      }
+
+    private:
+      // Discards all undone commands, which cannot be redone after a new command
+      void truncate()
+      {
+         if( position_ == commands_.size() ) return;
+
+         commands_.erase( commands_.begin()+position_, commands_.end() );
+         snapshots_.resize( ( position_ >> shift_ ) + 1UL );
+      }
+
+      // Doubles the snapshot interval and drops every other snapshot
+      void thin()
+      {
+         size_t k( 0UL );
+         for( size_t i=0UL; i<snapshots_.size(); i+=2UL ) {
+            snapshots_[k++] = snapshots_[i];
+         }
+         snapshots_.resize( k );
+         ++shift_;
+      }
+
+      int current_{};
+      size_t position_{};  // Number of applied commands
+      size_t shift_{};  // Logarithm of the snapshot interval
+      size_t max_snapshots_{};
+      std::vector<CalculatorCommand> commands_;
+      std::vector<int> snapshots_;  // Result after 'k*interval()' commands
+   };
+
+   void apply( Calculator& calculator, Operation const& op )
+   {
+      if( op.kind == Operation::undo ) {
+         calculator.undoLast();
+      }
+      else {
+         calculator.compute( CalculatorCommand( op.kind == Operation::add ? CalculatorCommand::addition
+                                                                          : CalculatorCommand::subtraction
+                                              , op.operand ) );
+      }
+   }
+
+   // Jumps to random points of the history and reports the average time per jump
+   void benchmark_jumps( char const* label, Calculator& calculator, unsigned int seed )
+   {
+      constexpr size_t jumps( 100000UL );
+
+      std::mt19937 rng{ seed };
+      std::uniform_int_distribution<size_t> index_dist( 0UL, calculator.history() );
+
+      std::vector<size_t> indices( jumps );
+      std::generate( begin(indices), end(indices), [&](){ return index_dist(rng); } );
+
+      std::chrono::time_point<std::chrono::high_resolution_clock> start, end;
+      start = std::chrono::high_resolution_clock::now();
+
+      long long checksum{};
+      for( size_t index : indices ) {
+         calculator.jumpTo( index );
+         checksum += calculator.result();
+      }
+
+      end = std::chrono::high_resolution_clock::now();
+      std::chrono::duration<double> const elapsedTime( end - start );
+      double const seconds( elapsedTime.count() );
+
+      std::ostringstream os;
+      os << " " << std::left << std::setw(32) << label << ": " << seconds/jumps*1E9 << "ns per jump"
+         << "  (history = " << calculator.history() << ", interval = " << calculator.interval()
+         << ", checksum = " << checksum << ")\n";
+      std::cout << os.str();
+   }
+
+} // namespace checkpointed_command_solution
+#endif
+
+
+#if BENCHMARK_COMMAND_SOLUTION && BENCHMARK_CHECKPOINTED_COMMAND_SOLUTION
+// Compares the checkpointed calculator with the command solution on a random sequence of
+// commands, undos, redos, and jumps. The small snapshot budget repeatedly triggers 'thin()'.
+// Since the command solution provides neither redo nor jumps, it is moved to the same position
+// of the history by undoing or re-executing commands.
+bool check_checkpointed_command_solution( unsigned int seed )
+{
+   using checkpointed_command_solution::CalculatorCommand;
+
+   std::mt19937 rng{ seed };
+   std::uniform_int_distribution<int> kind_dist( 1, 10 );
+   std::uniform_int_distribution<int> operand_dist( 1, 3 );
+
+   command_solution::Calculator reference{};
+   checkpointed_command_solution::Calculator calculator( 16UL*sizeof(int), 2UL );
+   std::vector<CalculatorCommand> history;
+   size_t position( 0UL );
+
+   auto const execute = [&reference]( CalculatorCommand const& command )
+   {
+      int const operand( command.operand() );
+
+      switch( command.opcode() ) {
+         case CalculatorCommand::addition:       reference.compute( std::make_unique<command_solution::Addition>( operand ) ); break;
+         case CalculatorCommand::subtraction:    reference.compute( std::make_unique<command_solution::Subtraction>( operand ) ); break;
+         case CalculatorCommand::multiplication: reference.compute( std::make_unique<command_solution::Multiplication>( operand ) ); break;
+      }
+   };
+
+   auto const move_to = [&]( size_t index )
+   {
+      for( ; position > index; --position ) reference.undoLast();
+      for( ; position < index; ++position ) execute( history[position] );
+   };
+
+   for( size_t step=0UL; step<10000UL; ++step )
+   {
+      int const kind( kind_dist(rng) );
+
+      if( kind <= 5 ) {
+         int const operand( operand_dist(rng) );
+         CalculatorCommand const command(
+            kind <= 2 && std::abs( reference.result() ) < 100000
+               ? CalculatorCommand( CalculatorCommand::multiplication, kind == 1 ? operand : -operand )
+               : CalculatorCommand( kind % 2 == 1 ? CalculatorCommand::addition : CalculatorCommand::subtraction, operand ) );
+
+         history.erase( history.begin()+position, history.end() );
+         history.push_back( command );
+         execute( command );
+         ++position;
+         calculator.compute( command );
+      }
+      else if( kind <= 7 ) {
+         calculator.undoLast();
+         move_to( position > 0UL ? position-1UL : 0UL );
+      }
+      else if( kind == 8 ) {
+         calculator.redo();
+         move_to( std::min( position+1UL, history.size() ) );
+      }
+      else {
+         size_t const index( std::uniform_int_distribution<size_t>( 0UL, history.size() )( rng ) );
+         calculator.jumpTo( index );
+         move_to( index );
+      }
+
+      if( calculator.position() != position || calculator.result() != reference.result() ) return false;
+   }
+
+   return true;
+}
+#endif
+
+
+// Applies all operations one by one to the given calculator. Solutions with a batch API provide
+// their own 'replay()' function.
+template< typename Calculator >
+void replay( Calculator& calculator, std::vector<Operation> const& operations )
+{
+   for( auto const& op : operations ) {
+      apply( calculator, op );
+   }
+}
+
+
+// Replays all operations on the given calculator
+template< typename Calculator >
+void benchmark( char const* label, Calculator& calculator, std::vector<Operation> const& operations )
+{
+   std::chrono::time_point<std::chrono::high_resolution_clock> start, end;
+   start = std::chrono::high_resolution_clock::now();
+
+   replay( calculator, operations );
+
+   end = std::chrono::high_resolution_clock::now();
+   std::chrono::duration<double> const elapsedTime( end - start );
+   double const seconds( elapsedTime.count() );
+
+   // The formatting flags are set on a local stream to leave 'std::cout' unchanged
+   std::ostringstream os;
+   os << " " << std::left << std::setw(32) << label << ": " << seconds << "s"
+      << "  (" << std::setprecision(4) << operations.size()/seconds/1E6 << "M ops/s"
+      << ", result = " << calculator.result() << ")\n";
+   std::cout << os.str();
+}
+
+
+int main()
+{
+   std::random_device rd{};
+   unsigned int const seed( rd() );
+
+   auto const operations( generate_operations( seed ) );
+
+   std::cout << std::endl;
+
+#if BENCHMARK_COMMAND_SOLUTION
+   {
+      using namespace command_solution;
+
+      Calculator calculator{};
+      benchmark( "Command (std::unique_ptr)", calculator, operations );
+   }
+#endif
+
+#if BENCHMARK_INLINE_COMMAND_SOLUTION
+   {
+      using namespace inline_command_solution;
+
+      Calculator calculator{ N };
+      benchmark( "Command (inline undo log)", calculator, operations );
+   }
+#endif
+
+#if BENCHMARK_BATCH_COMMAND_SOLUTION
+   {
+      using namespace batch_command_solution;
+
+      Calculator calculator{ N };
+      benchmark( "Command (fused batches)", calculator, operations );
+
+#if BENCHMARK_COMMAND_SOLUTION
+      if( !check_batch_command_solution( seed ) ) {
+         std::cerr << " Command (fused batches): result differs from the command solution\n";
+         return EXIT_FAILURE;
+      }
+#endif
+   }
+#endif
+
+#if BENCHMARK_CHECKPOINTED_COMMAND_SOLUTION
+   {
+      using namespace checkpointed_command_solution;
+
+      Calculator calculator{};
+      calculator.reserve( N );
+      benchmark( "Command (checkpointed history)", calculator, operations );
+      benchmark_jumps( "Command (checkpointed jumps)", calculator, seed );
+
+#if BENCHMARK_COMMAND_SOLUTION
+      if( !check_checkpointed_command_solution( seed ) ) {
+         std::cerr << " Command (checkpointed history): result differs from the command solution\n";
+         return EXIT_FAILURE;
+      }
+#endif
+   }
+#endif
+
+   std::cout << std::endl;
+
+   return EXIT_SUCCESS;
+}
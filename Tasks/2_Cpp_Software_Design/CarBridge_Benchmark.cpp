@@ -0,0 +1,552 @@
+/**************************************************************************************************
+*
+* \file CarBridge_Benchmark.cpp
+* \brief C++ Training - Benchmark for the Bridge Design Pattern (ElectricCar)
+*
+* Copyright (C) 2015-2023 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#define BENCHMARK_VIRTUAL_SOLUTION 1
+#define BENCHMARK_STATIC_SOLUTION 1
+#define BENCHMARK_VARIANT_SOLUTION 1
+
+
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <random>
+#include <sstream>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+
+//---- Configuration ------------------------------------------------------------------------------
+
+constexpr size_t fleet_size( 1000UL );  // Number of simulated cars
+constexpr size_t steps( 10000UL );  // Number of simulation steps (one drive per car and step)
+constexpr double hours( 0.1/3600.0 );  // Duration of a single simulation step (0.1s)
+
+// The generation of the engine and the battery of a car
+enum class Generation : std::uint8_t { gen1, gen2 };
+
+
+//---- <FastPimpl.h> ------------------------------------------------------------------------------
+
+// In-class storage for the implementation details of a class (see 'FastPimpl_Benchmark.cpp')
+template< typename Impl, size_t Size, size_t Align = alignof(std::max_align_t) >
+class fast_pimpl
+{
+   static_assert( std::has_single_bit( Align ), "The alignment must be a power of two" );
+
+ public:
+   template< typename... Args >
+      requires ( sizeof...(Args) != 1UL || !( std::is_same_v<std::remove_cvref_t<Args>,fast_pimpl> && ... ) )
+   explicit fast_pimpl( Args&&... args )
+   {
+      validate<sizeof(Impl),alignof(Impl)>();
+      std::construct_at( get(), std::forward<Args>(args)... );
+   }
+
+   ~fast_pimpl()
+   {
+      std::destroy_at( get() );
+   }
+
+   fast_pimpl( fast_pimpl const& other )
+   {
+      validate<sizeof(Impl),alignof(Impl)>();
+      std::construct_at( get(), *other );
+   }
+
+   fast_pimpl& operator=( fast_pimpl const& other )
+   {
+      **this = *other;
+      return *this;
+   }
+
+   fast_pimpl( fast_pimpl&& other ) noexcept( std::is_nothrow_move_constructible_v<Impl> )
+   {
+      validate<sizeof(Impl),alignof(Impl)>();
+      std::construct_at( get(), std::move(*other) );
+   }
+
+   fast_pimpl& operator=( fast_pimpl&& other ) noexcept( std::is_nothrow_move_assignable_v<Impl> )
+   {
+      **this = std::move(*other);
+      return *this;
+   }
+
+   Impl*       get()       noexcept { return std::launder( reinterpret_cast<Impl*>( buffer_.data() ) ); }
+   Impl const* get() const noexcept { return std::launder( reinterpret_cast<Impl const*>( buffer_.data() ) ); }
+
+   Impl&       operator*()       noexcept { return *get(); }
+   Impl const& operator*() const noexcept { return *get(); }
+
+   Impl*       operator->()       noexcept { return get(); }
+   Impl const* operator->() const noexcept { return get(); }
+
+ private:
+   template< size_t RequiredSize, size_t RequiredAlign >
+   static constexpr void validate() noexcept
+   {
+      static_assert( RequiredSize <= Size, "The size of the buffer is insufficient: Increase 'Size' to 'RequiredSize'" );
+      static_assert( RequiredAlign <= Align, "The alignment of the buffer is insufficient: Increase 'Align' to 'RequiredAlign'" );
+   }
+
+   alignas(Align) std::array<std::byte,Size> buffer_;  // Not initialized!
+};
+
+
+#if BENCHMARK_VIRTUAL_SOLUTION
+namespace virtual_solution {
+
+   // The design of 'Car_Bridge.cpp': The engine and the battery are reached via base class pointers
+
+   //---- <Engine.h> ------------------------------------------------------------------------------
+
+   class Engine
+   {
+    public:
+      virtual ~Engine() = default;
+      virtual void start() = 0;
+      virtual void stop() = 0;
+      virtual double power() const = 0;
+   };
+
+
+   //---- <Battery.h> -----------------------------------------------------------------------------
+
+   class Battery
+   {
+    public:
+      virtual ~Battery() = default;
+      virtual void drawPower( double energy ) = 0;
+      virtual double charge() const = 0;
+   };
+
+
+   //---- <ElectricEngineGen1.h> ------------------------------------------------------------------
+
+   class ElectricEngineGen1 : public Engine
+   {
+    public:
+      void start() override { running_ = true; ++starts_; }
+      void stop() override { running_ = false; }
+      double power() const override { return 100.0; }
+
+    private:
+      bool running_{};
+      size_t starts_{};
+   };
+
+
+   //---- <ElectricEngineGen2.h> ------------------------------------------------------------------
+
+   class ElectricEngineGen2 : public Engine
+   {
+    public:
+      void start() override { running_ = true; ++starts_; }
+      void stop() override { running_ = false; }
+      double power() const override { return 150.0; }
+
+    private:
+      bool running_{};
+      size_t starts_{};
+   };
+
+
+   //---- <BatteryGen1.h> -------------------------------------------------------------------------
+
+   class BatteryGen1 : public Battery
+   {
+    public:
+      void drawPower( double energy ) override { charge_ -= energy; }
+      double charge() const override { return charge_; }
+
+    private:
+      double charge_{ 80.0 };  // Electrical charge in kWh
+   };
+
+
+   //---- <BatteryGen2.h> -------------------------------------------------------------------------
+
+   class BatteryGen2 : public Battery
+   {
+    public:
+      void drawPower( double energy ) override { charge_ -= 0.9*energy; }
+      double charge() const override { return charge_; }
+
+    private:
+      double charge_{ 100.0 };  // Electrical charge in kWh
+   };
+
+
+   //---- <ElectricCar.h> -------------------------------------------------------------------------
+
+   class ElectricCar
+   {
+    public:
+      explicit ElectricCar( Generation generation );
+
+      void drive( double duration );
+      double charge() const;
+
+    private:
+      std::unique_ptr<Engine> engine_;
+      std::unique_ptr<Battery> battery_;
+   };
+
+
+   //---- <ElectricCar.cpp> -----------------------------------------------------------------------
+
+   ElectricCar::ElectricCar( Generation generation )
+   {
+      if( generation == Generation::gen1 ) {
+         engine_ = std::make_unique<ElectricEngineGen1>();
+         battery_ = std::make_unique<BatteryGen1>();
+      }
+      else {
+         engine_ = std::make_unique<ElectricEngineGen2>();
+         battery_ = std::make_unique<BatteryGen2>();
+      }
+   }
+
+   void ElectricCar::drive( double duration )
+   {
+      engine_->start();
+      battery_->drawPower( engine_->power() * duration );
+      engine_->stop();
+   }
+
+   double ElectricCar::charge() const
+   {
+      return battery_->charge();
+   }
+
+} // namespace virtual_solution
+#endif
+
+
+// The engines and batteries of the statically bound solutions. Since they are never accessed via
+// a base class, they don't need virtual functions.
+namespace components {
+
+   class ElectricEngineGen1
+   {
+    public:
+      void start() { running_ = true; ++starts_; }
+      void stop() { running_ = false; }
+      double power() const { return 100.0; }
+
+    private:
+      bool running_{};
+      size_t starts_{};
+   };
+
+   class ElectricEngineGen2
+   {
+    public:
+      void start() { running_ = true; ++starts_; }
+      void stop() { running_ = false; }
+      double power() const { return 150.0; }
+
+    private:
+      bool running_{};
+      size_t starts_{};
+   };
+
+   class BatteryGen1
+   {
+    public:
+      void drawPower( double energy ) { charge_ -= energy; }
+      double charge() const { return charge_; }
+
+    private:
+      double charge_{ 80.0 };  // Electrical charge in kWh
+   };
+
+   class BatteryGen2
+   {
+    public:
+      void drawPower( double energy ) { charge_ -= 0.9*energy; }
+      double charge() const { return charge_; }
+
+    private:
+      double charge_{ 100.0 };  // Electrical charge in kWh
+   };
+
+} // namespace components
+
+
+#if BENCHMARK_STATIC_SOLUTION
+namespace static_solution {
+
+   // The engine and the battery are bound at compile time. The header remains a compilation
+   // firewall: It neither includes nor mentions the engine and the battery types.
+
+   //---- <ElectricCar.h> -------------------------------------------------------------------------
+
+   //#include <FastPimpl.h>
+
+   class ElectricCar
+   {
+    public:
+      ElectricCar();
+      ~ElectricCar();
+
+      ElectricCar( ElectricCar const& other );
+      ElectricCar& operator=( ElectricCar const& other );
+
+      ElectricCar( ElectricCar&& other ) noexcept;
+      ElectricCar& operator=( ElectricCar&& other ) noexcept;
+
+      void drive( double duration );
+      double charge() const;
+
+    private:
+      struct Impl;
+
+      fast_pimpl<Impl,32UL,8UL> pimpl_;
+   };
+
+
+   //---- <ElectricCar.cpp> -----------------------------------------------------------------------
+
+   //#include <ElectricCar.h>
+   //#include <BatteryGen1.h>
+   //#include <ElectricEngineGen1.h>
+
+   struct ElectricCar::Impl
+   {
+      components::ElectricEngineGen1 engine_;
+      components::BatteryGen1        battery_;
+   };
+
+   ElectricCar::ElectricCar() : pimpl_{} {}
+   ElectricCar::~ElectricCar() = default;
+
+   ElectricCar::ElectricCar( ElectricCar const& other ) = default;
+   ElectricCar& ElectricCar::operator=( ElectricCar const& other ) = default;
+
+   ElectricCar::ElectricCar( ElectricCar&& other ) noexcept = default;
+   ElectricCar& ElectricCar::operator=( ElectricCar&& other ) noexcept = default;
+
+   void ElectricCar::drive( double duration )
+   {
+      pimpl_->engine_.start();
+      pimpl_->battery_.drawPower( pimpl_->engine_.power() * duration );
+      pimpl_->engine_.stop();
+   }
+
+   double ElectricCar::charge() const
+   {
+      return pimpl_->battery_.charge();
+   }
+
+} // namespace static_solution
+#endif
+
+
+#if BENCHMARK_VARIANT_SOLUTION
+namespace variant_solution {
+
+   // The engine and the battery are selected at runtime from a closed set of types. As for the
+   // static solution, the header does not reveal the set of types.
+
+   //---- <ElectricCar.h> -------------------------------------------------------------------------
+
+   //#include <FastPimpl.h>
+
+   class ElectricCar
+   {
+    public:
+      explicit ElectricCar( Generation generation );
+      ~ElectricCar();
+
+      ElectricCar( ElectricCar const& other );
+      ElectricCar& operator=( ElectricCar const& other );
+
+      ElectricCar( ElectricCar&& other ) noexcept;
+      ElectricCar& operator=( ElectricCar&& other ) noexcept;
+
+      void drive( double duration );
+      double charge() const;
+
+    private:
+      struct Impl;
+
+      fast_pimpl<Impl,48UL,8UL> pimpl_;
+   };
+
+
+   //---- <ElectricCar.cpp> -----------------------------------------------------------------------
+
+   //#include <ElectricCar.h>
+   //#include <BatteryGen1.h>
+   //#include <BatteryGen2.h>
+   //#include <ElectricEngineGen1.h>
+   //#include <ElectricEngineGen2.h>
+
+   struct ElectricCar::Impl
+   {
+      using Engine  = std::variant<components::ElectricEngineGen1,components::ElectricEngineGen2>;
+      using Battery = std::variant<components::BatteryGen1,components::BatteryGen2>;
+
+      explicit Impl( Generation generation )
+      {
+         if( generation == Generation::gen2 ) {
+            engine_.emplace<components::ElectricEngineGen2>();
+            battery_.emplace<components::BatteryGen2>();
+         }
+      }
+
+      Engine  engine_;
+      Battery battery_;
+   };
+
+   ElectricCar::ElectricCar( Generation generation ) : pimpl_{ generation } {}
+   ElectricCar::~ElectricCar() = default;
+
+   ElectricCar::ElectricCar( ElectricCar const& other ) = default;
+   ElectricCar& ElectricCar::operator=( ElectricCar const& other ) = default;
+
+   ElectricCar::ElectricCar( ElectricCar&& other ) noexcept = default;
+   ElectricCar& ElectricCar::operator=( ElectricCar&& other ) noexcept = default;
+
+   // A single dispatch for the combination of engine and battery
+   void ElectricCar::drive( double duration )
+   {
+      std::visit( [duration]( auto& engine, auto& battery ){
+         engine.start();
+         battery.drawPower( engine.power() * duration );
+         engine.stop();
+      }, pimpl_->engine_, pimpl_->battery_ );
+   }
+
+   double ElectricCar::charge() const
+   {
+      return std::visit( []( auto const& battery ){ return battery.charge(); }, pimpl_->battery_ );
+   }
+
+} // namespace variant_solution
+#endif
+
+
+//---- Benchmark ----------------------------------------------------------------------------------
+
+// Returns the generations of all cars of the fleet. In a mixed fleet, the generations are random.
+std::vector<Generation> generate_fleet( bool mixed, unsigned int seed )
+{
+   std::mt19937 rng{ seed };
+   std::bernoulli_distribution gen2( 0.5 );
+
+   std::vector<Generation> fleet( fleet_size, Generation::gen1 );
+   if( mixed ) {
+      for( auto& generation : fleet ) {
+         generation = gen2(rng) ? Generation::gen2 : Generation::gen1;
+      }
+   }
+   return fleet;
+}
+
+
+// Drives all cars of the fleet in every step of the simulation
+template< typename Car >
+void benchmark( char const* label, std::vector<Car>& cars )
+{
+   std::chrono::time_point<std::chrono::high_resolution_clock> start, end;
+   start = std::chrono::high_resolution_clock::now();
+
+   for( size_t step=0UL; step<steps; ++step ) {
+      for( auto& car : cars ) {
+         car.drive( hours );
+      }
+   }
+
+   end = std::chrono::high_resolution_clock::now();
+   std::chrono::duration<double> const elapsedTime( end - start );
+   double const seconds( elapsedTime.count() );
+
+   double total( 0.0 );
+   for( auto const& car : cars ) {
+      total += car.charge();
+   }
+
+   // The formatting flags are set on a local stream to leave 'std::cout' unchanged
+   std::ostringstream os;
+   os << " " << std::left << std::setw(32) << label << ": " << seconds << "s"
+      << "  (" << std::setprecision(4) << cars.size()*steps/seconds/1E6 << "M drives/s"
+      << ", remaining charge = " << total << " kWh)\n";
+   std::cout << os.str();
+}
+
+
+template< typename Car >
+std::vector<Car> make_cars( std::vector<Generation> const& fleet )
+{
+   std::vector<Car> cars;
+   cars.reserve( fleet.size() );
+   for( Generation generation : fleet ) {
+      cars.emplace_back( generation );
+   }
+   return cars;
+}
+
+
+int main()
+{
+   std::random_device rd{};
+   unsigned int const seed( rd() );
+
+   std::cout << "\n Fixed generation (Gen1 only)\n";
+   {
+      auto const fleet( generate_fleet( false, seed ) );
+
+#if BENCHMARK_VIRTUAL_SOLUTION
+      auto cars( make_cars<virtual_solution::ElectricCar>( fleet ) );
+      benchmark( "Virtual functions", cars );
+#endif
+
+#if BENCHMARK_STATIC_SOLUTION
+      std::vector<static_solution::ElectricCar> static_cars( fleet.size() );
+      benchmark( "Statically bound (fast pimpl)", static_cars );
+#endif
+
+#if BENCHMARK_VARIANT_SOLUTION
+      auto variant_cars( make_cars<variant_solution::ElectricCar>( fleet ) );
+      benchmark( "std::variant (fast pimpl)", variant_cars );
+#endif
+   }
+
+   std::cout << "\n Mixed generations (Gen1 and Gen2)\n";
+   {
+      auto const fleet( generate_fleet( true, seed ) );
+
+#if BENCHMARK_VIRTUAL_SOLUTION
+      auto cars( make_cars<virtual_solution::ElectricCar>( fleet ) );
+      benchmark( "Virtual functions", cars );
+#endif
+
+#if BENCHMARK_VARIANT_SOLUTION
+      auto variant_cars( make_cars<variant_solution::ElectricCar>( fleet ) );
+      benchmark( "std::variant (fast pimpl)", variant_cars );
+#endif
+   }
+
+   std::cout << std::endl;
+
+   return EXIT_SUCCESS;
+}
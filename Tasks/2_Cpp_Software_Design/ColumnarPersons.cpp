@@ -0,0 +1,568 @@
+/**************************************************************************************************
+*
+* \file ColumnarPersons.cpp
+* \brief C++ Training - Data Members Performance Benchmark for a Columnar Person Table
+*
+* Copyright (C) 2015-2023 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+* Task: Copy-and-paste the following code into 'quick-bench.com'. Benchmark the time to determine
+*       the oldest person and to select all persons born in the 1970s, both for the Person
+*       layouts of 'BridgedMembers.cpp' and for a columnar table with SIMD kernels.
+*
+**************************************************************************************************/
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#if ( defined(__GNUC__) || defined(__clang__) ) && ( defined(__x86_64__) || defined(__i386__) )
+#  define KERNELS_AVX2 1
+#  include <immintrin.h>
+#else
+#  define KERNELS_AVX2 0
+#endif
+
+
+//---- Benchmark configuration --------------------------------------------------------------------
+
+// The Person layouts with six 'std::string' members require about 200 bytes per person, the
+// columnar table about 28 bytes per person
+constexpr size_t min_size( 10000 );  // Smallest size of the generated containers
+constexpr size_t max_person_size( 1000000 );  // Largest size of the Person containers
+constexpr size_t max_table_size( 100000000 );  // Largest size of the columnar table
+constexpr size_t iterations( 100 );  // Number of benchmark iterations
+
+#define BENCHMARK_PERSON1 1
+#define BENCHMARK_PERSON2 1
+#define BENCHMARK_PERSON3 1
+#define BENCHMARK_PERSON4 1
+#define BENCHMARK_PERSON5 1
+#define BENCHMARK_PERSON6 1
+#define BENCHMARK_PERSON_TABLE 1
+
+
+//---- Random Number Setup ------------------------------------------------------------------------
+
+std::random_device rd{};
+const unsigned int seed( rd() );
+
+std::mt19937 rng{ seed };
+std::uniform_int_distribution<int> dist( 1957, 2004 );
+
+int get_random_year_of_birth()
+{
+   return dist( rng );
+}
+
+std::vector<int> get_random_years_of_birth( size_t n )
+{
+   std::vector<int> years( n );
+   std::generate( begin(years), end(years), [](){
+      return get_random_year_of_birth();
+   } );
+   return years;
+}
+
+
+//---- Person implementations ---------------------------------------------------------------------
+
+struct Person1
+{
+   std::string forename{ "Homer" };
+   std::string surname{ "Simpson" };
+   std::string address{ "712 Red Bark Lane" };
+   std::string zip{ "89011" };
+   std::string city{ "Henderson" };
+   std::string state{ "Nevada" };
+   int year_of_birth{ get_random_year_of_birth() };
+};
+
+struct Person2
+{
+   struct Pimpl {
+      std::string forename{ "Homer" };
+      std::string surname{ "Simpson" };
+      std::string address{ "712 Red Bark Lane" };
+      std::string zip{ "89011" };
+      std::string city{ "Henderson" };
+      std::string state{ "Nevada" };
+      int year_of_birth{ get_random_year_of_birth() };
+   };
+
+   std::unique_ptr<Pimpl> pimpl{ new Pimpl{} };
+};
+
+struct Person3
+{
+   std::string forename{ "Homer" };
+   std::string surname{ "Simpson" };
+   int year_of_birth{ get_random_year_of_birth() };
+
+   struct Pimpl {
+      std::string address{ "712 Red Bark Lane" };
+      std::string zip{ "89011" };
+      std::string city{ "Henderson" };
+      std::string state{ "Nevada" };
+   };
+
+   std::unique_ptr<Pimpl> pimpl{ new Pimpl{} };
+};
+
+struct Person4
+{
+   int year_of_birth{ get_random_year_of_birth() };
+
+   struct Pimpl {
+      std::string forename{ "Homer" };
+      std::string surname{ "Simpson" };
+      std::string address{ "712 Red Bark Lane" };
+      std::string zip{ "89011" };
+      std::string city{ "Henderson" };
+      std::string state{ "Nevada" };
+   };
+
+   std::unique_ptr<Pimpl> pimpl{ new Pimpl{} };
+};
+
+struct Pimpl5
+{
+   std::string forename{ "Homer" };
+   std::string surname{ "Simpson" };
+   int year_of_birth{ get_random_year_of_birth() };
+   std::string address{ "712 Red Bark Lane" };
+   std::string zip{ "89011" };
+   std::string city{ "Henderson" };
+   std::string state{ "Nevada" };
+};
+
+template< typename Pimpl >
+struct Person5
+{
+   Pimpl pimpl;
+};
+
+struct Person6
+{
+   static std::vector<int> years_of_birth;
+   size_t id{};
+
+   struct Pimpl {
+      std::string forename{ "Homer" };
+      std::string surname{ "Simpson" };
+      std::string address{ "712 Red Bark Lane" };
+      std::string zip{ "89011" };
+      std::string city{ "Henderson" };
+      std::string state{ "Nevada" };
+   };
+
+   std::unique_ptr<Pimpl> pimpl{ new Pimpl{} };
+};
+
+std::vector<int> Person6::years_of_birth{};
+
+
+//---- String arena -------------------------------------------------------------------------------
+
+// Stores every distinct string exactly once in a chunked buffer. Strings are referred to by
+// 4-byte handles, which remain valid for the lifetime of the arena. An arena can be shared
+// between several tables.
+class StringArena
+{
+ public:
+   using Handle = std::uint32_t;
+
+   Handle intern( std::string_view s )
+   {
+      if( auto const pos = index_.find( s ); pos != index_.end() ) {
+         return pos->second;
+      }
+
+      char* const data( allocate( s.size() ) );
+      std::memcpy( data, s.data(), s.size() );
+
+      Handle const handle( static_cast<Handle>( views_.size() ) );
+      views_.emplace_back( data, s.size() );
+      index_.emplace( views_.back(), handle );
+      return handle;
+   }
+
+   std::string_view view( Handle handle ) const { return views_[handle]; }
+
+   size_t size() const { return views_.size(); }
+
+ private:
+   static constexpr size_t chunk_size = 64UL*1024UL;
+
+   char* allocate( size_t n )
+   {
+      if( chunks_.empty() || used_ + n > chunk_size ) {
+         chunks_.emplace_back( std::make_unique<char[]>( std::max( n, chunk_size ) ) );
+         used_ = 0UL;
+      }
+      char* const ptr( chunks_.back().get() + used_ );
+      used_ += n;
+      return ptr;
+   }
+
+   std::vector< std::unique_ptr<char[]> > chunks_;
+   size_t used_{};
+   std::vector<std::string_view> views_;
+   std::unordered_map<std::string_view,Handle> index_;
+};
+
+
+//---- SIMD kernels -------------------------------------------------------------------------------
+
+namespace kernels {
+
+   // Returns the index of the first smallest element (equivalent to 'std::min_element()')
+   size_t argmin_scalar( std::span<int const> values )
+   {
+      return std::distance( values.begin(), std::min_element( values.begin(), values.end() ) );
+   }
+
+   // Writes the indices of all elements within [lo,hi] to the front of 'out' and returns their
+   // number. 'out' must provide (at least) the same number of elements as 'values', so that it
+   // can be allocated once and reused for many selections.
+   size_t select_between_scalar( std::span<int const> values, int lo, int hi, std::span<std::uint32_t> out )
+   {
+      size_t count( 0UL );
+      for( size_t i=0UL; i<values.size(); ++i ) {
+         if( lo <= values[i] && values[i] <= hi ) {
+            out[count++] = static_cast<std::uint32_t>( i );
+         }
+      }
+      return count;
+   }
+
+#if KERNELS_AVX2
+   __attribute__((target("avx2")))
+   size_t argmin_avx2( std::span<int const> values )
+   {
+      size_t const n( values.size() );
+
+      if( n < 16UL || n > static_cast<size_t>( INT32_MAX ) ) {
+         return argmin_scalar( values );
+      }
+
+      int const* const data( values.data() );
+
+      // Every lane tracks its smallest value and the index of its first occurrence
+      __m256i minv( _mm256_loadu_si256( reinterpret_cast<__m256i const*>( data ) ) );
+      __m256i mini( _mm256_setr_epi32( 0, 1, 2, 3, 4, 5, 6, 7 ) );
+      __m256i idx ( mini );
+      __m256i const step( _mm256_set1_epi32( 8 ) );
+
+      size_t i( 8UL );
+      for( ; i+8UL<=n; i+=8UL ) {
+         idx = _mm256_add_epi32( idx, step );
+         __m256i const v( _mm256_loadu_si256( reinterpret_cast<__m256i const*>( data+i ) ) );
+         __m256i const less( _mm256_cmpgt_epi32( minv, v ) );
+         minv = _mm256_min_epi32( minv, v );
+         mini = _mm256_blendv_epi8( mini, idx, less );
+      }
+
+      alignas(32) int vals[8];
+      alignas(32) int idxs[8];
+      _mm256_store_si256( reinterpret_cast<__m256i*>( vals ), minv );
+      _mm256_store_si256( reinterpret_cast<__m256i*>( idxs ), mini );
+
+      size_t best( 0UL );
+      for( size_t lane=1UL; lane<8UL; ++lane ) {
+         if( vals[lane] < vals[best] || ( vals[lane] == vals[best] && idxs[lane] < idxs[best] ) ) {
+            best = lane;
+         }
+      }
+
+      int value( vals[best] );
+      size_t index( static_cast<size_t>( idxs[best] ) );
+
+      for( ; i<n; ++i ) {
+         if( data[i] < value ) {
+            value = data[i];
+            index = i;
+         }
+      }
+
+      return index;
+   }
+
+   __attribute__((target("avx2")))
+   size_t select_between_avx2( std::span<int const> values, int lo, int hi, std::span<std::uint32_t> out )
+   {
+      size_t const n( values.size() );
+      int const* const data( values.data() );
+
+      std::uint32_t* result( out.data() );
+
+      __m256i const lov( _mm256_set1_epi32( lo ) );
+      __m256i const hiv( _mm256_set1_epi32( hi ) );
+
+      size_t i( 0UL );
+      for( ; i+8UL<=n; i+=8UL ) {
+         __m256i const v( _mm256_loadu_si256( reinterpret_cast<__m256i const*>( data+i ) ) );
+         __m256i const outside( _mm256_or_si256( _mm256_cmpgt_epi32( lov, v ), _mm256_cmpgt_epi32( v, hiv ) ) );
+         unsigned int mask( ~static_cast<unsigned int>( _mm256_movemask_ps( _mm256_castsi256_ps( outside ) ) ) & 0xFFU );
+
+         while( mask ) {
+            *result++ = static_cast<std::uint32_t>( i + std::countr_zero( mask ) );
+            mask &= mask - 1U;
+         }
+      }
+
+      for( ; i<n; ++i ) {
+         if( lo <= data[i] && data[i] <= hi ) {
+            *result++ = static_cast<std::uint32_t>( i );
+         }
+      }
+
+      return static_cast<size_t>( result - out.data() );
+   }
+
+   bool has_avx2()
+   {
+      static bool const avx2( __builtin_cpu_supports( "avx2" ) );
+      return avx2;
+   }
+#endif
+
+   size_t argmin( std::span<int const> values )
+   {
+#if KERNELS_AVX2
+      if( has_avx2() ) return argmin_avx2( values );
+#endif
+      return argmin_scalar( values );
+   }
+
+   size_t select_between( std::span<int const> values, int lo, int hi, std::span<std::uint32_t> out )
+   {
+#if KERNELS_AVX2
+      if( has_avx2() ) return select_between_avx2( values, lo, hi, out );
+#endif
+      return select_between_scalar( values, lo, hi, out );
+   }
+
+} // namespace kernels
+
+
+//---- Columnar Person table ----------------------------------------------------------------------
+
+// Stores every data member of the persons in a separate column. All strings are interned in a
+// (potentially shared) arena, the string columns only store the 4-byte handles.
+class PersonTable
+{
+ public:
+   using Handle = StringArena::Handle;
+
+   explicit PersonTable( std::shared_ptr<StringArena> arena )
+      : arena_( std::move( arena ) )
+   {}
+
+   // Creates 'n' default persons, equivalent to 'std::vector<Person1> persons( n )'
+   PersonTable( std::shared_ptr<StringArena> arena, size_t n )
+      : PersonTable( std::move( arena ) )
+   {
+      forenames_.assign( n, arena_->intern( "Homer" ) );
+      surnames_ .assign( n, arena_->intern( "Simpson" ) );
+      addresses_.assign( n, arena_->intern( "712 Red Bark Lane" ) );
+      zips_     .assign( n, arena_->intern( "89011" ) );
+      cities_   .assign( n, arena_->intern( "Henderson" ) );
+      states_   .assign( n, arena_->intern( "Nevada" ) );
+      years_of_birth_ = get_random_years_of_birth( n );
+   }
+
+   void push_back( std::string_view forename, std::string_view surname, std::string_view address
+                 , std::string_view zip, std::string_view city, std::string_view state, int year_of_birth )
+   {
+      forenames_.push_back( arena_->intern( forename ) );
+      surnames_ .push_back( arena_->intern( surname ) );
+      addresses_.push_back( arena_->intern( address ) );
+      zips_     .push_back( arena_->intern( zip ) );
+      cities_   .push_back( arena_->intern( city ) );
+      states_   .push_back( arena_->intern( state ) );
+      years_of_birth_.push_back( year_of_birth );
+   }
+
+   size_t size() const { return years_of_birth_.size(); }
+
+   std::string_view forename( size_t i ) const { return arena_->view( forenames_[i] ); }
+   std::string_view surname ( size_t i ) const { return arena_->view( surnames_[i] ); }
+   std::string_view address ( size_t i ) const { return arena_->view( addresses_[i] ); }
+   std::string_view zip     ( size_t i ) const { return arena_->view( zips_[i] ); }
+   std::string_view city    ( size_t i ) const { return arena_->view( cities_[i] ); }
+   std::string_view state   ( size_t i ) const { return arena_->view( states_[i] ); }
+   int year_of_birth        ( size_t i ) const { return years_of_birth_[i]; }
+
+   std::span<int const> years_of_birth() const { return years_of_birth_; }
+
+ private:
+   std::shared_ptr<StringArena> arena_;
+   std::vector<Handle> forenames_;
+   std::vector<Handle> surnames_;
+   std::vector<Handle> addresses_;
+   std::vector<Handle> zips_;
+   std::vector<Handle> cities_;
+   std::vector<Handle> states_;
+   std::vector<int> years_of_birth_;
+};
+
+size_t determineOldest( PersonTable const& persons )
+{
+   return kernels::argmin( persons.years_of_birth() );
+}
+
+// Writes the indices of all persons born in [first,last] to the front of 'out' and returns their
+// number ('out' must provide at least one element per person)
+size_t selectBornBetween( PersonTable const& persons, int first, int last, std::span<std::uint32_t> out )
+{
+   return kernels::select_between( persons.years_of_birth(), first, last, out );
+}
+
+
+//---- Benchmarks for Person1 to Person6 ----------------------------------------------------------
+
+template< typename Person, typename Projection >
+static void determineOldestPerson(benchmark::State& state, Projection year_of_birth)
+{
+   std::vector<Person> persons( static_cast<size_t>( state.range(0) ) );
+
+   for( auto _ : state )
+   {
+      benchmark::DoNotOptimize(
+         std::min_element( begin(persons), end(persons), [&]( auto const& p1, auto const& p2 ){
+            return year_of_birth( p1 ) < year_of_birth( p2 );
+         } )
+      );
+   }
+}
+
+static void determineOldestPerson1(benchmark::State& state)
+{
+   determineOldestPerson<Person1>( state, []( Person1 const& p ){ return p.year_of_birth; } );
+}
+#if BENCHMARK_PERSON1
+BENCHMARK(determineOldestPerson1)->RangeMultiplier(10)->Range(min_size,max_person_size)->Iterations(iterations);
+#endif
+
+static void determineOldestPerson2(benchmark::State& state)
+{
+   determineOldestPerson<Person2>( state, []( Person2 const& p ){ return p.pimpl->year_of_birth; } );
+}
+#if BENCHMARK_PERSON2
+BENCHMARK(determineOldestPerson2)->RangeMultiplier(10)->Range(min_size,max_person_size)->Iterations(iterations);
+#endif
+
+static void determineOldestPerson3(benchmark::State& state)
+{
+   determineOldestPerson<Person3>( state, []( Person3 const& p ){ return p.year_of_birth; } );
+}
+#if BENCHMARK_PERSON3
+BENCHMARK(determineOldestPerson3)->RangeMultiplier(10)->Range(min_size,max_person_size)->Iterations(iterations);
+#endif
+
+static void determineOldestPerson4(benchmark::State& state)
+{
+   determineOldestPerson<Person4>( state, []( Person4 const& p ){ return p.year_of_birth; } );
+}
+#if BENCHMARK_PERSON4
+BENCHMARK(determineOldestPerson4)->RangeMultiplier(10)->Range(min_size,max_person_size)->Iterations(iterations);
+#endif
+
+static void determineOldestPerson5(benchmark::State& state)
+{
+   determineOldestPerson<Person5<Pimpl5>>( state, []( Person5<Pimpl5> const& p ){ return p.pimpl.year_of_birth; } );
+}
+#if BENCHMARK_PERSON5
+BENCHMARK(determineOldestPerson5)->RangeMultiplier(10)->Range(min_size,max_person_size)->Iterations(iterations);
+#endif
+
+static void determineOldestPerson6(benchmark::State& state)
+{
+   size_t const n( static_cast<size_t>( state.range(0) ) );
+
+   std::vector<Person6> persons( n );
+   for( size_t i=0; i<n; ++i ) {
+      persons[i].id = i;
+   }
+   Person6::years_of_birth = get_random_years_of_birth( n );
+
+   for( auto _ : state )
+   {
+      // Prevents the compiler from hoisting the search out of the benchmark loop
+      benchmark::DoNotOptimize( Person6::years_of_birth.data() );
+      benchmark::ClobberMemory();
+
+      benchmark::DoNotOptimize(
+         std::distance( begin(Person6::years_of_birth)
+                      , std::min_element( begin(Person6::years_of_birth), end(Person6::years_of_birth) ) )
+      );
+   }
+}
+#if BENCHMARK_PERSON6
+BENCHMARK(determineOldestPerson6)->RangeMultiplier(10)->Range(min_size,max_person_size)->Iterations(iterations);
+#endif
+
+
+//---- Benchmarks for the columnar Person table ---------------------------------------------------
+
+static void determineOldestPersonTable(benchmark::State& state)
+{
+   PersonTable const persons( std::make_shared<StringArena>(), static_cast<size_t>( state.range(0) ) );
+
+   for( auto _ : state )
+   {
+      benchmark::DoNotOptimize( persons.years_of_birth().data() );
+      benchmark::ClobberMemory();
+
+      benchmark::DoNotOptimize( determineOldest( persons ) );
+   }
+}
+#if BENCHMARK_PERSON_TABLE
+BENCHMARK(determineOldestPersonTable)->RangeMultiplier(10)->Range(min_size,max_table_size)->Iterations(iterations);
+#endif
+
+static void selectPerson1(benchmark::State& state)
+{
+   std::vector<Person1> persons( static_cast<size_t>( state.range(0) ) );
+   std::vector<Person1 const*> selection;
+
+   for( auto _ : state )
+   {
+      selection.clear();
+      for( auto const& p : persons ) {
+         if( 1970 <= p.year_of_birth && p.year_of_birth <= 1979 ) {
+            selection.push_back( &p );
+         }
+      }
+      benchmark::DoNotOptimize( selection.data() );
+   }
+}
+#if BENCHMARK_PERSON1
+BENCHMARK(selectPerson1)->RangeMultiplier(10)->Range(min_size,max_person_size)->Iterations(iterations);
+#endif
+
+static void selectPersonTable(benchmark::State& state)
+{
+   PersonTable const persons( std::make_shared<StringArena>(), static_cast<size_t>( state.range(0) ) );
+   std::vector<std::uint32_t> selection( persons.size() );
+
+   for( auto _ : state )
+   {
+      benchmark::DoNotOptimize( selectBornBetween( persons, 1970, 1979, selection ) );
+   }
+}
+#if BENCHMARK_PERSON_TABLE
+BENCHMARK(selectPersonTable)->RangeMultiplier(10)->Range(min_size,max_table_size)->Iterations(iterations);
+#endif
@@ -0,0 +1,468 @@
+/**************************************************************************************************
+*
+* \file CommandJournal_Benchmark.cpp
+* \brief C++ Training - Benchmark for a Persistent Command Journal (Calculator)
+*
+* Copyright (C) 2015-2023 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#if defined(__unix__) || defined(__APPLE__)
+#  define JOURNAL_MMAP 1
+#else
+#  define JOURNAL_MMAP 0
+#endif
+
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+#if JOURNAL_MMAP
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+
+//---- Operation stream ---------------------------------------------------------------------------
+
+// The input of the benchmark: A random sequence of additions, subtractions, and undo operations
+struct Operation
+{
+   enum Kind : std::uint8_t { add, subtract, undo };
+
+   Kind kind{};
+   int operand{};
+};
+
+constexpr size_t N( 10000000UL );  // Number of operations
+
+
+std::vector<Operation> generate_operations( unsigned int seed )
+{
+   std::mt19937 rng{ seed };
+   std::uniform_int_distribution<int> kind_dist( 1, 20 );
+   std::uniform_int_distribution<int> operand_dist( 1, 100 );
+
+   std::vector<Operation> operations;
+   operations.reserve( N );
+
+   while( operations.size() < N )
+   {
+      int const random_value( kind_dist(rng) );
+
+      if( random_value <= 9 ) {
+         operations.push_back( Operation{ Operation::add, operand_dist(rng) } );
+      }
+      else if( random_value <= 18 ) {
+         operations.push_back( Operation{ Operation::subtract, operand_dist(rng) } );
+      }
+      else {
+         operations.push_back( Operation{ Operation::undo, 0 } );
+      }
+   }
+
+   return operations;
+}
+
+
+#if JOURNAL_MMAP
+
+//---- Journal ------------------------------------------------------------------------------------
+
+// A fixed-size journal record: the opcode and the operand of a command. The padding bytes are
+// explicit members, such that no uninitialized bytes are written to the journal file.
+struct Record
+{
+   enum Opcode : std::uint8_t { addition, subtraction, undo };
+
+   Record() = default;
+   Record( Opcode opcode, std::int32_t operand ) : opcode(opcode), operand(operand) {}
+
+   Opcode opcode{};
+   std::uint8_t padding[3]{};
+   std::int32_t operand{};
+};
+
+static_assert( sizeof(Record) == 8UL );
+
+
+// An append-only, memory-mapped file of records. Appended records are written directly into the
+// mapping, but only become part of the journal with the next (group) commit, which publishes the
+// number of committed records in the file header. A journal that is reopened after a crash
+// therefore contains all records up to the last commit. With 'Durability::process', committed
+// records survive a crash of the process (they reside in the page cache of the OS), with
+// 'Durability::system' every commit is additionally flushed to the disk via 'msync()'.
+class Journal
+{
+ public:
+   enum class Durability { process, system };
+
+   explicit Journal( std::filesystem::path const& path, size_t group_size = 4096UL
+                   , Durability durability = Durability::process )
+      : group_size_( std::max( group_size, size_t{1} ) )
+      , durability_( durability )
+   {
+      fd_ = ::open( path.c_str(), O_RDWR | O_CREAT, 0644 );
+      if( fd_ < 0 ) throw std::system_error( errno, std::generic_category(), "open" );
+
+      // Since the destructor is not called for a partially constructed journal, the mapping and
+      // the file descriptor are released before any exception leaves the constructor
+      try {
+         struct stat st{};
+         if( ::fstat( fd_, &st ) != 0 ) throw std::system_error( errno, std::generic_category(), "fstat" );
+
+         if( static_cast<size_t>( st.st_size ) < sizeof(Header) ) {
+            map( initial_capacity );
+            std::memcpy( header()->magic, magic, sizeof(magic) );
+            header()->committed = 0UL;
+         }
+         else {
+            map( ( static_cast<size_t>( st.st_size ) - sizeof(Header) ) / sizeof(Record) );
+            if( std::memcmp( header()->magic, magic, sizeof(magic) ) != 0 ) {
+               throw std::runtime_error( "Invalid journal file" );
+            }
+            if( header()->committed > capacity_ ) {
+               throw std::runtime_error( "Corrupt journal file: committed records exceed the file size" );
+            }
+            // Records after the last commit are discarded
+            size_ = committed_ = header()->committed;
+         }
+      }
+      catch( ... ) {
+         unmap();
+         ::close( fd_ );
+         throw;
+      }
+   }
+
+   ~Journal()
+   {
+      // A failing flush cannot be propagated from the destructor, but is not silently ignored
+      try {
+         if( data_ ) commit();
+      }
+      catch( std::system_error const& ex ) {
+         std::cerr << " Journal: final commit failed (" << ex.what() << ")\n";
+      }
+      unmap();
+      ::close( fd_ );
+   }
+
+   Journal( Journal const& ) = delete;
+   Journal& operator=( Journal const& ) = delete;
+
+   void append( Record const& record )
+   {
+      if( size_ == capacity_ ) grow();
+
+      records()[size_++] = record;
+
+      if( size_ - committed_ >= group_size_ ) commit();
+   }
+
+   // Publishes all appended records. With 'Durability::system', a failing flush throws a
+   // 'std::system_error', in which case the records are not committed.
+   void commit()
+   {
+      if( committed_ == size_ ) return;
+
+      if( durability_ == Durability::system ) {
+         sync( sizeof(Header) + committed_*sizeof(Record), ( size_-committed_ )*sizeof(Record) );
+      }
+
+      // The release store keeps the record stores from being reordered after the commit
+      std::atomic_ref<std::uint64_t>( header()->committed ).store( size_, std::memory_order_release );
+
+      if( durability_ == Durability::system ) {
+         sync( 0UL, sizeof(Header) );
+      }
+
+      committed_ = size_;
+   }
+
+   // All committed records
+   std::span<Record const> committed() const { return { records(), committed_ }; }
+
+   size_t bytes() const { return sizeof(Header) + capacity_*sizeof(Record); }
+
+ private:
+   struct Header
+   {
+      char magic[8];
+      std::uint64_t committed;
+      char padding[48];
+   };
+
+   static_assert( sizeof(Header) == 64UL );
+
+   static constexpr char magic[8] = { 'C', 'A', 'L', 'C', 'J', 'R', 'N', 'L' };
+   static constexpr size_t initial_capacity = 1UL << 20;
+
+   Header* header() const { return static_cast<Header*>( data_ ); }
+   Record* records() const { return reinterpret_cast<Record*>( static_cast<std::byte*>( data_ ) + sizeof(Header) ); }
+
+   void map( size_t capacity )
+   {
+      capacity_ = std::max( capacity, initial_capacity );
+
+      if( ::ftruncate( fd_, static_cast<off_t>( bytes() ) ) != 0 ) {
+         throw std::system_error( errno, std::generic_category(), "ftruncate" );
+      }
+
+      void* const data( ::mmap( nullptr, bytes(), PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0 ) );
+      if( data == MAP_FAILED ) throw std::system_error( errno, std::generic_category(), "mmap" );
+      data_ = data;
+   }
+
+   void unmap() noexcept
+   {
+      if( data_ ) ::munmap( data_, bytes() );
+      data_ = nullptr;
+   }
+
+   void grow()
+   {
+      size_t const capacity( 2UL*capacity_ );
+      unmap();
+      map( capacity );
+   }
+
+   void sync( size_t offset, size_t length )
+   {
+      size_t const page( static_cast<size_t>( ::sysconf( _SC_PAGESIZE ) ) );
+      size_t const first( offset / page * page );
+      if( ::msync( static_cast<std::byte*>( data_ ) + first, offset + length - first, MS_SYNC ) != 0 ) {
+         throw std::system_error( errno, std::system_category(), "msync" );
+      }
+   }
+
+   int fd_{ -1 };
+   void* data_{};
+   size_t capacity_{};   // Number of records that fit into the mapping
+   size_t size_{};       // Number of appended records
+   size_t committed_{};  // Number of committed records
+   size_t group_size_{};
+   Durability durability_{};
+};
+
+
+//---- Calculator ---------------------------------------------------------------------------------
+
+// A calculator with a compact command history, which is optionally appended to a journal
+class Calculator
+{
+ public:
+   explicit Calculator( Journal* journal = nullptr ) : journal_( journal ) {}
+
+   void compute( Record const& command )
+   {
+      current_ += sign( command ) * command.operand;
+      history_.push_back( command );
+      if( journal_ ) journal_->append( command );
+   }
+
+   void undoLast()
+   {
+      if( history_.empty() ) return;
+
+      current_ -= sign( history_.back() ) * history_.back().operand;
+      history_.pop_back();
+      if( journal_ ) journal_->append( Record{ Record::undo, 0 } );
+   }
+
+   // Restores the history and the result from the given journal records. The history is rebuilt
+   // as a stack without any branch on the opcode (an undo overwrites the previous record), the
+   // result is computed by a single pass over the final history.
+   void restore( std::span<Record const> records )
+   {
+      history_.resize( records.size() + 1UL );
+
+      size_t top( 0UL );
+      for( auto const& record : records ) {
+         history_[top] = record;
+         size_t const undo( record.opcode == Record::undo );
+         top = top + 1UL - undo - undo*static_cast<size_t>( top > 0UL );
+      }
+      history_.resize( top );
+
+      int sum( 0 );
+      for( auto const& command : history_ ) {
+         sum += sign( command ) * command.operand;
+      }
+      current_ = sum;
+   }
+
+   int result() const { return current_; }
+   size_t history() const { return history_.size(); }
+
+ private:
+   static int sign( Record const& command )
+   {
+      return 1 - 2*static_cast<int>( command.opcode == Record::subtraction );
+   }
+
+   int current_{};
+   std::vector<Record> history_;
+   Journal* journal_{};
+};
+
+
+void apply( Calculator& calculator, Operation const& op )
+{
+   if( op.kind == Operation::undo ) {
+      calculator.undoLast();
+   }
+   else {
+      calculator.compute( Record{ op.kind == Operation::add ? Record::addition : Record::subtraction, op.operand } );
+   }
+}
+
+
+//---- Benchmarks ---------------------------------------------------------------------------------
+
+// Applies all operations to a calculator, which appends all commands to a new journal
+void benchmark_recording( char const* label, std::filesystem::path const& path, std::span<Operation const> operations
+                        , size_t group_size, Journal::Durability durability )
+{
+   std::filesystem::remove( path );
+
+   std::chrono::time_point<std::chrono::high_resolution_clock> start, end;
+   start = std::chrono::high_resolution_clock::now();
+
+   int result{};
+   {
+      Journal journal( path, group_size, durability );
+      Calculator calculator( &journal );
+      for( auto const& op : operations ) {
+         apply( calculator, op );
+      }
+      result = calculator.result();
+   }
+
+   end = std::chrono::high_resolution_clock::now();
+   std::chrono::duration<double> const elapsedTime( end - start );
+   double const seconds( elapsedTime.count() );
+
+   // The formatting flags are set on a local stream to leave 'std::cout' unchanged
+   std::ostringstream os;
+   os << " " << std::left << std::setw(36) << label << ": " << seconds << "s"
+      << "  (" << std::setprecision(4) << operations.size()/seconds/1E6 << "M ops/s"
+      << ", result = " << result << ")\n";
+   std::cout << os.str();
+}
+
+// Restores a calculator from an existing journal
+void benchmark_replay( char const* label, std::filesystem::path const& path )
+{
+   std::chrono::time_point<std::chrono::high_resolution_clock> start, end;
+   start = std::chrono::high_resolution_clock::now();
+
+   Journal journal( path );
+   Calculator calculator{};
+   calculator.restore( journal.committed() );
+
+   end = std::chrono::high_resolution_clock::now();
+   std::chrono::duration<double> const elapsedTime( end - start );
+   double const seconds( elapsedTime.count() );
+
+   size_t const records( journal.committed().size() );
+
+   std::ostringstream os;
+   os << " " << std::left << std::setw(36) << label << ": " << seconds << "s"
+      << "  (" << std::setprecision(4) << records*sizeof(Record)/seconds/1E9 << " GB/s"
+      << ", " << records << " records, result = " << calculator.result() << ")\n";
+   std::cout << os.str();
+}
+
+// Reference: Copying the same amount of memory into a freshly allocated buffer (as the replay,
+// which has to allocate and touch the memory for the restored history)
+void benchmark_memcpy( char const* label, size_t bytes )
+{
+   std::vector<std::byte> const source( bytes, std::byte{1} );
+
+   std::chrono::time_point<std::chrono::high_resolution_clock> start, end;
+   start = std::chrono::high_resolution_clock::now();
+
+   std::unique_ptr<std::byte[]> const target( new std::byte[bytes] );
+   std::memcpy( target.get(), source.data(), bytes );
+
+   end = std::chrono::high_resolution_clock::now();
+   std::chrono::duration<double> const elapsedTime( end - start );
+   double const seconds( elapsedTime.count() );
+
+   std::ostringstream os;
+   os << " " << std::left << std::setw(36) << label << ": " << seconds << "s"
+      << "  (" << std::setprecision(4) << bytes/seconds/1E9 << " GB/s"
+      << ", checksum = " << static_cast<int>( target[bytes/2UL] ) << ")\n";
+   std::cout << os.str();
+}
+
+#endif
+
+
+int main()
+{
+#if JOURNAL_MMAP
+   std::random_device rd{};
+   unsigned int const seed( rd() );
+
+   auto const operations( generate_operations( seed ) );
+   auto const path( std::filesystem::temp_directory_path() / "calculator.journal" );
+
+   std::cout << std::endl;
+
+   {
+      Calculator calculator{};
+      std::chrono::time_point<std::chrono::high_resolution_clock> start, end;
+      start = std::chrono::high_resolution_clock::now();
+      for( auto const& op : operations ) {
+         apply( calculator, op );
+      }
+      end = std::chrono::high_resolution_clock::now();
+      std::chrono::duration<double> const elapsedTime( end - start );
+      double const seconds( elapsedTime.count() );
+
+      std::ostringstream os;
+      os << " " << std::left << std::setw(36) << "Without journal" << ": " << seconds << "s"
+         << "  (" << std::setprecision(4) << operations.size()/seconds/1E6 << "M ops/s"
+         << ", result = " << calculator.result() << ")\n";
+      std::cout << os.str();
+   }
+
+   benchmark_recording( "Journal (group commit, msync)", path, std::span( operations ).first( N/10UL )
+                      , 65536UL, Journal::Durability::system );
+   benchmark_recording( "Journal (group commit, page cache)", path, operations
+                      , 4096UL, Journal::Durability::process );
+
+   benchmark_replay( "Replay", path );
+   benchmark_memcpy( "Reference (memcpy)", N*sizeof(Record) );
+
+   std::filesystem::remove( path );
+
+   std::cout << std::endl;
+#else
+   std::cout << "\n The command journal requires a POSIX system (mmap)\n\n";
+#endif
+
+   return EXIT_SUCCESS;
+}
@@ -0,0 +1,420 @@
+/**************************************************************************************************
+*
+* \file CommandQueue_Benchmark.cpp
+* \brief C++ Training - Benchmark for Commands Submitted by Multiple Threads (Calculator)
+*
+* Copyright (C) 2015-2023 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#define BENCHMARK_LOCKED_SOLUTION 1
+#define BENCHMARK_QUEUE_SOLUTION 1
+
+
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <span>
+#include <sstream>
+#include <stack>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+
+constexpr size_t N( 4000000UL );  // Total number of commands (of all producers)
+
+
+// The operands of a single producer. Since all commands are additions or subtractions, the final
+// result is independent of the order in which the commands of different producers are executed.
+std::vector<int> generate_operands( size_t n, unsigned int seed )
+{
+   std::mt19937 rng{ seed };
+   std::uniform_int_distribution<int> operand_dist( -100, 100 );
+
+   std::vector<int> operands( n );
+   for( auto& operand : operands ) {
+      operand = operand_dist(rng);
+   }
+   return operands;
+}
+
+
+// Waits for a while after an unsuccessful attempt: a few retries, then yield the time slice
+void backoff( unsigned int& attempts )
+{
+   if( ++attempts > 16U ) {
+      std::this_thread::yield();
+   }
+}
+
+
+#if BENCHMARK_LOCKED_SOLUTION
+namespace locked_solution {
+
+   class CalculatorCommand
+   {
+    public:
+      virtual ~CalculatorCommand() = default;
+
+      virtual int execute( int i ) const = 0;
+      virtual int undo( int i ) const = 0;
+   };
+
+   class Addition : public CalculatorCommand
+   {
+    public:
+      explicit Addition( int operand ) : operand_(operand) {}
+
+      int execute( int i ) const override { return i + operand_; }
+      int undo( int i ) const override { return i - operand_; }
+
+    private:
+      int operand_{};
+   };
+
+   class Subtraction : public CalculatorCommand
+   {
+    public:
+      explicit Subtraction( int operand ) : operand_(operand) {}
+
+      int execute( int i ) const override { return i - operand_; }
+      int undo( int i ) const override { return i + operand_; }
+
+    private:
+      int operand_{};
+   };
+
+   // The calculator of 'Calculator_Command.cpp', which executes every command synchronously on
+   // the calling thread. Concurrent calls are serialized by a mutex.
+   class Calculator
+   {
+    public:
+      void compute( std::unique_ptr<CalculatorCommand> command )
+      {
+         std::lock_guard<std::mutex> const lock( mutex_ );
+         current_ = command->execute( current_ );
+         stack_.push( std::move(command) );
+      }
+
+      int result() const
+      {
+         std::lock_guard<std::mutex> const lock( mutex_ );
+         return current_;
+      }
+
+    private:
+      using CommandStack = std::stack<std::unique_ptr<CalculatorCommand>>;
+
+      mutable std::mutex mutex_;
+      int current_{};
+      CommandStack stack_;
+   };
+
+   int run( std::vector< std::vector<int> > const& operands )
+   {
+      Calculator calculator{};
+
+      std::vector<std::jthread> producers;
+      for( auto const& ops : operands ) {
+         producers.emplace_back( [&calculator,&ops](){
+            for( int operand : ops ) {
+               if( operand >= 0 ) calculator.compute( std::make_unique<Addition>( operand ) );
+               else calculator.compute( std::make_unique<Subtraction>( -operand ) );
+            }
+         } );
+      }
+      producers.clear();  // Joins all producers
+
+      return calculator.result();
+   }
+
+} // namespace locked_solution
+#endif
+
+
+#if BENCHMARK_QUEUE_SOLUTION
+namespace queue_solution {
+
+   // A compact, trivially copyable command, which is stored inline in the queue
+   class CalculatorCommand
+   {
+    public:
+      enum Opcode : std::uint8_t { addition, subtraction };
+
+      CalculatorCommand() = default;
+      CalculatorCommand( Opcode opcode, int operand ) : opcode_(opcode), operand_(operand) {}
+
+      Opcode opcode() const { return opcode_; }
+      int operand() const { return operand_; }
+
+      // Selects the operation without a branch on the (unpredictable) opcode
+      int execute( int i ) const { return i + ( 1 - 2*static_cast<int>( opcode_ == subtraction ) ) * operand_; }
+
+    private:
+      Opcode opcode_{};
+      int operand_{};
+   };
+
+
+   // A bounded, lock-free multi-producer/single-consumer queue (based on the bounded queue by
+   // Dmitry Vyukov). Every slot carries a sequence number, which tells producers whether the slot
+   // is free and the consumer whether the slot has been written. Producers claim a position by a
+   // CAS on the tail, the consumer owns the head and never competes with another thread.
+   template< typename T, size_t Capacity >
+   class MPSCQueue
+   {
+      static_assert( std::has_single_bit( Capacity ), "The capacity must be a power of two" );
+      static_assert( std::is_trivially_copyable_v<T> );
+
+    public:
+      MPSCQueue()
+      {
+         for( size_t i=0UL; i<Capacity; ++i ) {
+            slots_[i].sequence.store( i, std::memory_order_relaxed );
+         }
+      }
+
+      MPSCQueue( MPSCQueue const& ) = delete;
+      MPSCQueue& operator=( MPSCQueue const& ) = delete;
+
+      // Returns false in case the queue is full
+      bool try_push( T const& value )
+      {
+         size_t pos( tail_.load( std::memory_order_relaxed ) );
+
+         while( true )
+         {
+            Slot& slot( slots_[pos & mask] );
+            size_t const sequence( slot.sequence.load( std::memory_order_acquire ) );
+            std::ptrdiff_t const diff( static_cast<std::ptrdiff_t>( sequence - pos ) );
+
+            if( diff == 0 ) {
+               if( tail_.compare_exchange_weak( pos, pos+1UL, std::memory_order_relaxed ) ) {
+                  slot.value = value;
+                  slot.sequence.store( pos+1UL, std::memory_order_release );
+                  return true;
+               }
+            }
+            else if( diff < 0 ) {
+               return false;
+            }
+            else {
+               pos = tail_.load( std::memory_order_relaxed );
+            }
+         }
+      }
+
+      // Backpressure: blocks the producer as long as the queue is full
+      void push( T const& value )
+      {
+         unsigned int attempts{};
+         while( !try_push( value ) ) {
+            backoff( attempts );
+         }
+      }
+
+      // Moves up to 'out.size()' elements into 'out' and returns their number (consumer only)
+      size_t pop( std::span<T> out )
+      {
+         size_t n( 0UL );
+
+         while( n < out.size() )
+         {
+            Slot& slot( slots_[head_ & mask] );
+            if( slot.sequence.load( std::memory_order_acquire ) != head_+1UL ) break;
+
+            out[n++] = slot.value;
+            slot.sequence.store( head_+Capacity, std::memory_order_release );
+            ++head_;
+         }
+
+         return n;
+      }
+
+    private:
+      static constexpr size_t mask = Capacity - 1UL;
+
+      struct Slot
+      {
+         std::atomic<size_t> sequence{};
+         T value{};
+      };
+
+      // Producers and the consumer work on separate cache lines
+      alignas(64) std::atomic<size_t> tail_{};
+      alignas(64) size_t head_{};
+      alignas(64) std::unique_ptr<Slot[]> slots_{ std::make_unique<Slot[]>( Capacity ) };
+   };
+
+
+   // Drains the queue on a dedicated thread and executes the commands in batches
+   class Executor
+   {
+    public:
+      static constexpr size_t capacity   = 1UL << 14;
+      static constexpr size_t batch_size = 256UL;
+
+      Executor() : thread_( [this](){ run(); } ) {}
+
+      ~Executor() { stop(); }
+
+      void submit( CalculatorCommand const& command ) { queue_.push( command ); }
+
+      // Executes all submitted commands and stops the executor thread
+      void stop()
+      {
+         done_.store( true, std::memory_order_release );
+         if( thread_.joinable() ) thread_.join();
+      }
+
+      int result() const { return current_; }  // Valid after 'stop()'
+      size_t executed() const { return executed_; }  // Valid after 'stop()'
+
+    private:
+      void run()
+      {
+         std::vector<CalculatorCommand> batch( batch_size );
+         unsigned int attempts{};
+
+         while( true )
+         {
+            // Reading 'done_' before draining guarantees that no command is missed
+            bool const done( done_.load( std::memory_order_acquire ) );
+            size_t const n( queue_.pop( batch ) );
+
+            if( n > 0UL ) {
+               execute( std::span<CalculatorCommand const>( batch.data(), n ) );
+               attempts = 0U;
+            }
+            else if( done ) {
+               return;
+            }
+            else {
+               backoff( attempts );
+            }
+         }
+      }
+
+      // Fuses the batch of additions and subtractions into a single addition
+      void execute( std::span<CalculatorCommand const> commands )
+      {
+         int sum( 0 );
+         for( auto const& command : commands ) {
+            sum = command.execute( sum );
+         }
+         current_ += sum;
+         executed_ += commands.size();
+      }
+
+      MPSCQueue<CalculatorCommand,capacity> queue_;
+      std::atomic<bool> done_{ false };
+      int current_{};
+      size_t executed_{};
+      std::thread thread_;  // Declared last to start after all other data members
+   };
+
+   int run( std::vector< std::vector<int> > const& operands )
+   {
+      Executor executor{};
+
+      std::vector<std::jthread> producers;
+      for( auto const& ops : operands ) {
+         producers.emplace_back( [&executor,&ops](){
+            for( int operand : ops ) {
+               executor.submit( operand >= 0 ? CalculatorCommand( CalculatorCommand::addition, operand )
+                                             : CalculatorCommand( CalculatorCommand::subtraction, -operand ) );
+            }
+         } );
+      }
+      producers.clear();  // Joins all producers
+      executor.stop();
+
+      // A lost or duplicated command would only show up as a slightly different result
+      size_t submitted( 0UL );
+      for( auto const& ops : operands ) {
+         submitted += ops.size();
+      }
+      if( executor.executed() != submitted ) {
+         throw std::runtime_error( "The executor did not execute every submitted command exactly once" );
+      }
+
+      return executor.result();
+   }
+
+} // namespace queue_solution
+#endif
+
+
+// Runs the given solution with the given number of producers. All producers start at the same
+// time and submit 'N/producers' commands each.
+template< typename Run >
+void benchmark( size_t producers, unsigned int seed, Run run )
+{
+   std::vector< std::vector<int> > operands;
+   for( size_t p=0UL; p<producers; ++p ) {
+      operands.push_back( generate_operands( N/producers, seed+p ) );
+   }
+
+   std::chrono::time_point<std::chrono::high_resolution_clock> start, end;
+   start = std::chrono::high_resolution_clock::now();
+
+   int const result( run( operands ) );
+
+   end = std::chrono::high_resolution_clock::now();
+   std::chrono::duration<double> const elapsedTime( end - start );
+   double const seconds( elapsedTime.count() );
+
+   // The formatting flags are set on a local stream to leave 'std::cout' unchanged
+   std::ostringstream os;
+   os << std::setw(12) << std::setprecision(4) << N/producers*producers/seconds/1E6 << "M ops/s"
+      << " (" << std::setw(9) << result << ")";
+   std::cout << os.str();
+}
+
+
+int main()
+{
+   std::random_device rd{};
+   unsigned int const seed( rd() );
+
+   std::cout << "\n Producers"
+#if BENCHMARK_LOCKED_SOLUTION
+             << "                std::mutex"
+#endif
+#if BENCHMARK_QUEUE_SOLUTION
+             << "                MPSC queue"
+#endif
+             << "\n";
+
+   for( size_t producers : { 1UL, 2UL, 4UL, 8UL, 16UL } )
+   {
+      std::cout << " " << std::setw(9) << producers;
+
+#if BENCHMARK_LOCKED_SOLUTION
+      benchmark( producers, seed, locked_solution::run );
+#endif
+
+#if BENCHMARK_QUEUE_SOLUTION
+      benchmark( producers, seed, queue_solution::run );
+#endif
+
+      std::cout << "\n";
+   }
+
+   std::cout << std::endl;
+
+   return EXIT_SUCCESS;
+}
@@ -0,0 +1,432 @@
+/**************************************************************************************************
+*
+* \file ContainerAdapter_Benchmark.cpp
+* \brief C++ Training - Benchmark for a Virtual and a Statically Dispatched Container Adapter
+*
+* Copyright (C) 2015-2023 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#define BENCHMARK_VIRTUAL_SOLUTION 1
+#define BENCHMARK_STATIC_SOLUTION 1
+
+
+#include <algorithm>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <new>
+#include <random>
+#include <sstream>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+#if BENCHMARK_VIRTUAL_SOLUTION
+namespace virtual_solution {
+
+   // The classic object adapter of 'Adapter_1.cpp': Every operation is a virtual function call
+   template< typename T >
+   class Container
+   {
+    public:
+      virtual ~Container() = default;
+
+      virtual void push_back( const T& ) = 0;
+      virtual void pop_back() = 0;
+      virtual T const& back() const = 0;
+      virtual size_t size() const = 0;
+      virtual void print( std::ostream& ) const = 0;
+   };
+
+   template< typename T >
+   class Vector : public Container<T>
+   {
+    public:
+      void push_back( const T& value ) override { vector_.push_back( value ); }
+      void pop_back() override { vector_.pop_back(); }
+      T const& back() const override { return vector_.back(); }
+      size_t size() const override { return vector_.size(); }
+      void print( std::ostream& os ) const override
+      {
+         os << "(";
+         for( const auto& value : vector_ ) os << " " << value;
+         os << " )";
+      }
+
+    private:
+      std::vector<T> vector_;
+   };
+
+   template< typename T >
+   class List : public Container<T>
+   {
+    public:
+      void push_back( const T& value ) override { list_.push_back( value ); }
+      void pop_back() override { list_.pop_back(); }
+      T const& back() const override { return list_.back(); }
+      size_t size() const override { return list_.size(); }
+      void print( std::ostream& os ) const override
+      {
+         os << "(";
+         for( const auto& value : list_ ) os << " " << value;
+         os << " )";
+      }
+
+    private:
+      std::list<T> list_;
+   };
+
+} // namespace virtual_solution
+#endif
+
+
+#if BENCHMARK_STATIC_SOLUTION
+namespace static_solution {
+
+   //---- <Container.h> ---------------------------------------------------------------------------
+
+   // The same API as the 'Container' base class of 'Adapter_1.cpp', formulated as a concept.
+   // Any type that models the concept can be used without inheritance and without virtual
+   // function calls.
+   template< typename C >
+   concept Container =
+      requires ( C c, C const& cc, typename C::value_type const& value, std::ostream& os ) {
+         c.push_back( value );
+         c.pop_back();
+         { cc.back() } -> std::convertible_to<typename C::value_type const&>;
+         { cc.size() } -> std::convertible_to<size_t>;
+         cc.print( os );
+      };
+
+
+   //---- <Vector.h> ------------------------------------------------------------------------------
+
+   template< typename T >
+   class Vector
+   {
+    public:
+      using value_type = T;
+
+      void push_back( const T& value ) { vector_.push_back( value ); }
+      void pop_back() { vector_.pop_back(); }
+      T const& back() const { return vector_.back(); }
+      size_t size() const { return vector_.size(); }
+      void print( std::ostream& os ) const
+      {
+         os << "(";
+         for( const auto& value : vector_ ) os << " " << value;
+         os << " )";
+      }
+
+    private:
+      std::vector<T> vector_;
+   };
+
+
+   //---- <List.h> --------------------------------------------------------------------------------
+
+   template< typename T >
+   class List
+   {
+    public:
+      using value_type = T;
+
+      void push_back( const T& value ) { list_.push_back( value ); }
+      void pop_back() { list_.pop_back(); }
+      T const& back() const { return list_.back(); }
+      size_t size() const { return list_.size(); }
+      void print( std::ostream& os ) const
+      {
+         os << "(";
+         for( const auto& value : list_ ) os << " " << value;
+         os << " )";
+      }
+
+    private:
+      std::list<T> list_;
+   };
+
+
+   //---- <SmallVector.h> -------------------------------------------------------------------------
+
+   // A contiguous container that stores up to 'N' elements within the object itself. Only in
+   // case the size exceeds 'N', the elements are moved to a dynamically allocated buffer.
+   template< typename T, size_t N >
+   class SmallVector
+   {
+      static_assert( N > 0UL, "The inline capacity must not be zero" );
+
+    public:
+      using value_type = T;
+
+      SmallVector() = default;
+
+      SmallVector( SmallVector const& other )
+      {
+         reserve( other.size_ );
+         std::uninitialized_copy_n( other.data_, other.size_, data_ );
+         size_ = other.size_;
+      }
+
+      SmallVector( SmallVector&& other ) noexcept( std::is_nothrow_move_constructible_v<T> )
+      {
+         steal( other );
+      }
+
+      SmallVector& operator=( SmallVector const& other )
+      {
+         if( this != &other ) {
+            clear();
+            reserve( other.size_ );
+            std::uninitialized_copy_n( other.data_, other.size_, data_ );
+            size_ = other.size_;
+         }
+         return *this;
+      }
+
+      SmallVector& operator=( SmallVector&& other ) noexcept( std::is_nothrow_move_constructible_v<T> )
+      {
+         if( this != &other ) {
+            clear();
+            deallocate();
+            steal( other );
+         }
+         return *this;
+      }
+
+      ~SmallVector()
+      {
+         clear();
+         deallocate();
+      }
+
+      void push_back( const T& value )
+      {
+         if( size_ == capacity_ ) {
+            // A copy protects against 'value' being an element of this container
+            T tmp( value );
+            reserve( 2UL*capacity_ );
+            std::construct_at( data_+size_, std::move(tmp) );
+         }
+         else {
+            std::construct_at( data_+size_, value );
+         }
+         ++size_;
+      }
+
+      void pop_back() { std::destroy_at( data_ + --size_ ); }
+
+      T const& back() const { return data_[size_-1UL]; }
+      size_t size() const { return size_; }
+      size_t capacity() const { return capacity_; }
+      bool is_inline() const { return data_ == inline_data(); }
+
+      void clear() noexcept
+      {
+         std::destroy_n( data_, size_ );
+         size_ = 0UL;
+      }
+
+      void reserve( size_t capacity )
+      {
+         if( capacity <= capacity_ ) return;
+
+         T* const data( std::allocator<T>{}.allocate( capacity ) );
+         std::uninitialized_move_n( data_, size_, data );  // Assumes a non-throwing move
+         std::destroy_n( data_, size_ );
+         deallocate();
+         data_ = data;
+         capacity_ = capacity;
+      }
+
+      void print( std::ostream& os ) const
+      {
+         os << "(";
+         for( size_t i=0UL; i<size_; ++i ) os << " " << data_[i];
+         os << " )";
+      }
+
+    private:
+      T*       inline_data()       noexcept { return std::launder( reinterpret_cast<T*>( buffer_ ) ); }
+      T const* inline_data() const noexcept { return std::launder( reinterpret_cast<T const*>( buffer_ ) ); }
+
+      void deallocate() noexcept
+      {
+         if( !is_inline() ) {
+            std::allocator<T>{}.deallocate( data_, capacity_ );
+            data_ = inline_data();
+            capacity_ = N;
+         }
+      }
+
+      // Takes over the elements of 'other', which is left empty (precondition: 'this' is empty
+      // and inline)
+      void steal( SmallVector& other ) noexcept( std::is_nothrow_move_constructible_v<T> )
+      {
+         if( other.is_inline() ) {
+            std::uninitialized_move_n( other.data_, other.size_, data_ );
+            size_ = other.size_;
+            other.clear();
+         }
+         else {
+            data_ = std::exchange( other.data_, other.inline_data() );
+            capacity_ = std::exchange( other.capacity_, N );
+            size_ = std::exchange( other.size_, 0UL );
+         }
+      }
+
+      alignas(T) std::byte buffer_[N*sizeof(T)];  // Not initialized!
+      T* data_{ inline_data() };
+      size_t size_{};
+      size_t capacity_{ N };
+   };
+
+} // namespace static_solution
+#endif
+
+
+//---- Benchmark ----------------------------------------------------------------------------------
+
+constexpr size_t requests( 1000000UL );  // Number of simulated requests
+
+
+// The input of all solutions: The push and pop operations of all requests. A non-negative value
+// is pushed, a negative value pops the last element. Most requests use at most 8 elements, a
+// few use up to 'large' elements.
+struct Workload
+{
+   std::vector<int> operations;
+   std::vector<size_t> offsets;  // The operations of request 'i' are [offsets[i],offsets[i+1])
+};
+
+Workload generate_workload( size_t large, unsigned int seed )
+{
+   std::mt19937 rng{ seed };
+   std::bernoulli_distribution is_large( 0.05 );
+   std::bernoulli_distribution push( 0.7 );
+   std::uniform_int_distribution<int> value( 0, 1000 );
+
+   Workload workload{};
+   workload.offsets.push_back( 0UL );
+
+   for( size_t r=0UL; r<requests; ++r )
+   {
+      size_t const limit( is_large(rng)
+                          ? std::uniform_int_distribution<size_t>( 9UL, large )( rng )
+                          : std::uniform_int_distribution<size_t>( 1UL, 8UL )( rng ) );
+
+      size_t size( 0UL );
+      for( size_t i=0UL; i<2UL*limit; ++i ) {
+         if( size == 0UL || ( size < limit && push(rng) ) ) {
+            workload.operations.push_back( value(rng) );
+            ++size;
+         }
+         else {
+            workload.operations.push_back( -1 );
+            --size;
+         }
+      }
+      workload.offsets.push_back( workload.operations.size() );
+   }
+
+   return workload;
+}
+
+
+// Access to the container, independent of whether it is held by value or by pointer
+template< typename T > T& deref( std::unique_ptr<T>& container ) { return *container; }
+template< typename T > T& deref( T& container ) { return container; }
+
+
+// Every request creates a new container via 'create()', performs its operations on it, and
+// contributes the final size and the last element to the checksum
+template< typename Create >
+void benchmark( char const* label, Workload const& workload, Create create )
+{
+   size_t checksum( 0UL );
+
+   std::chrono::time_point<std::chrono::high_resolution_clock> start, end;
+   start = std::chrono::high_resolution_clock::now();
+
+   for( size_t r=0UL; r<requests; ++r )
+   {
+      auto container( create() );
+      auto& c( deref( container ) );
+
+      for( size_t i=workload.offsets[r]; i<workload.offsets[r+1UL]; ++i ) {
+         int const operation( workload.operations[i] );
+         if( operation < 0 ) c.pop_back();
+         else c.push_back( operation );
+      }
+
+      checksum += c.size() + ( c.size() > 0UL ? static_cast<size_t>( c.back() ) : 0UL );
+   }
+
+   end = std::chrono::high_resolution_clock::now();
+   std::chrono::duration<double> const elapsedTime( end - start );
+   double const seconds( elapsedTime.count() );
+
+   // The formatting flags are set on a local stream to leave 'std::cout' unchanged
+   std::ostringstream os;
+   os << " " << std::left << std::setw(34) << label << ": " << std::right
+      << std::setw(8) << std::setprecision(4) << seconds/workload.operations.size()*1E9
+      << " ns/op  (checksum = " << checksum << ")\n";
+   std::cout << os.str();
+}
+
+
+int main()
+{
+   std::random_device rd{};
+   unsigned int const seed( rd() );
+
+#if BENCHMARK_STATIC_SOLUTION
+   static_assert( static_solution::Container<static_solution::Vector<int>> );
+   static_assert( static_solution::Container<static_solution::List<int>> );
+   static_assert( static_solution::Container<static_solution::SmallVector<int,8UL>> );
+#endif
+
+   for( size_t large : { 16UL, 64UL } )
+   {
+      Workload const workload( generate_workload( large, seed ) );
+
+      std::cout << "\n " << requests << " requests, " << workload.operations.size()
+                << " operations (95% of the requests use at most 8 elements, 5% up to "
+                << large << ")\n";
+
+#if BENCHMARK_VIRTUAL_SOLUTION
+      {
+         using namespace virtual_solution;
+
+         benchmark( "Virtual Container (Vector)", workload,
+            [](){ return std::unique_ptr<Container<int>>( std::make_unique<Vector<int>>() ); } );
+         benchmark( "Virtual Container (List)", workload,
+            [](){ return std::unique_ptr<Container<int>>( std::make_unique<List<int>>() ); } );
+      }
+#endif
+
+#if BENCHMARK_STATIC_SOLUTION
+      {
+         using namespace static_solution;
+
+         benchmark( "Static Container (Vector)", workload, [](){ return Vector<int>{}; } );
+         benchmark( "Static Container (List)", workload, [](){ return List<int>{}; } );
+         benchmark( "Static Container (SmallVector<8>)", workload, [](){ return SmallVector<int,8UL>{}; } );
+      }
+#endif
+   }
+
+   std::cout << std::endl;
+
+   return EXIT_SUCCESS;
+}
@@ -0,0 +1,598 @@
+/**************************************************************************************************
+*
+* \file CowShape_Benchmark.cpp
+* \brief C++ Training - Benchmark for Copy-on-Write Type Erasure and Prototypes
+*
+* Copyright (C) 2015-2023 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#define BENCHMARK_DEEP_COPY_SOLUTION 1
+#define BENCHMARK_COPY_ON_WRITE_SOLUTION 1
+#define BENCHMARK_EAGER_PROTOTYPE_SOLUTION 1
+#define BENCHMARK_COPY_ON_WRITE_PROTOTYPE_SOLUTION 1
+
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+//---- Configuration ------------------------------------------------------------------------------
+
+constexpr size_t scene_size( 1000UL );  // Number of shapes in the scene (and animals in the herd)
+constexpr size_t frames( 2000UL );  // Number of simulated frames
+constexpr size_t history_size( 64UL );  // Number of scene snapshots kept for undo
+
+
+//---- <Point.h> ----------------------------------------------------------------------------------
+
+struct Point
+{
+   double x;
+   double y;
+};
+
+
+//---- <Circle.h> ---------------------------------------------------------------------------------
+
+//#include <Point.h>
+
+class Circle
+{
+ public:
+   explicit Circle( double radius, Point center = {} )
+      : radius_( radius )
+      , center_( center )
+   {}
+
+   double radius() const { return radius_; }
+   Point  center() const { return center_; }
+
+   void translate( Point const& offset ) { center_.x += offset.x; center_.y += offset.y; }
+
+ private:
+   double radius_;
+   Point center_;
+};
+
+
+//---- <Square.h> ---------------------------------------------------------------------------------
+
+//#include <Point.h>
+
+class Square
+{
+ public:
+   explicit Square( double side, Point center = {} )
+      : side_( side )
+      , center_( center )
+   {}
+
+   double side() const { return side_; }
+   Point center() const { return center_; }
+
+   void translate( Point const& offset ) { center_.x += offset.x; center_.y += offset.y; }
+
+ private:
+   double side_;
+   Point center_;
+};
+
+
+//---- <Draw.h> -----------------------------------------------------------------------------------
+
+// Instead of drawing to the screen, the draw operations accumulate a checksum
+double canvas{};
+
+void free_draw( Circle const& circle )
+{
+   canvas += circle.radius() + circle.center().x + circle.center().y;
+}
+
+void free_draw( Square const& square )
+{
+   canvas += square.side() + square.center().x + square.center().y;
+}
+
+void free_translate( Circle& circle, Point const& offset ) { circle.translate( offset ); }
+void free_translate( Square& square, Point const& offset ) { square.translate( offset ); }
+
+
+#if BENCHMARK_DEEP_COPY_SOLUTION
+namespace deep_copy_solution {
+
+   // The 'Shape' of 'TypeErasure.cpp': Every copy of a shape clones the shape
+   class Shape
+   {
+    public:
+      template< typename ShapeT >
+      Shape( ShapeT const& shape )
+         : pimpl_( std::make_unique<Model<ShapeT>>( shape ) )
+      {}
+
+      Shape( Shape const& other )
+         : pimpl_( other.pimpl_->clone() )
+      {}
+
+      Shape& operator=( const Shape& other )
+      {
+         // Copy-and-swap idiom
+         Shape tmp( other );
+         std::swap( pimpl_, tmp.pimpl_ );
+         return *this;
+      }
+
+      ~Shape() = default;
+      Shape( Shape&& ) = default;
+      Shape& operator=( Shape&& ) = default;
+
+    private:
+      friend void free_draw( Shape const& shape )
+      {
+         shape.pimpl_->do_draw();
+      }
+
+      friend void free_translate( Shape& shape, Point const& offset )
+      {
+         shape.pimpl_->do_translate( offset );
+      }
+
+      struct Concept
+      {
+         virtual ~Concept() = default;
+         virtual void do_draw() const = 0;
+         virtual void do_translate( Point const& offset ) = 0;
+         virtual std::unique_ptr<Concept> clone() const = 0;
+      };
+
+      template< typename ShapeT >
+      struct Model final : public Concept
+      {
+         explicit Model( ShapeT const& shape )
+            : shape_( shape )
+         {}
+
+         void do_draw() const final { free_draw( shape_ ); }
+         void do_translate( Point const& offset ) final { free_translate( shape_, offset ); }
+         std::unique_ptr<Concept> clone() const final { return std::make_unique<Model>(*this); }
+
+         ShapeT shape_;
+      };
+
+      std::unique_ptr<Concept> pimpl_;
+   };
+
+} // namespace deep_copy_solution
+#endif
+
+
+#if BENCHMARK_COPY_ON_WRITE_SOLUTION
+namespace copy_on_write_solution {
+
+   // All copies of a shape share the same, immutable model. A copy only increments the reference
+   // count of the model. The model is cloned only when a shared shape is modified for the first
+   // time. The reference count is atomic, such that copies of a shape can be used and destroyed
+   // by different threads. Note that (as for 'int') a single shape must not be modified by one
+   // thread while it is used by another thread.
+   class Shape
+   {
+    public:
+      template< typename ShapeT >
+      Shape( ShapeT const& shape )
+         : pimpl_( new Model<ShapeT>( shape ) )
+      {}
+
+      Shape( Shape const& other ) noexcept
+         : pimpl_( other.pimpl_ )
+      {
+         pimpl_->acquire();
+      }
+
+      Shape& operator=( const Shape& other ) noexcept
+      {
+         // Copy-and-swap idiom
+         Shape tmp( other );
+         std::swap( pimpl_, tmp.pimpl_ );
+         return *this;
+      }
+
+      ~Shape()
+      {
+         if( pimpl_ ) pimpl_->release();
+      }
+
+      Shape( Shape&& other ) noexcept
+         : pimpl_( std::exchange( other.pimpl_, nullptr ) )
+      {}
+
+      Shape& operator=( Shape&& other ) noexcept
+      {
+         std::swap( pimpl_, other.pimpl_ );
+         return *this;
+      }
+
+    private:
+      friend void free_draw( Shape const& shape )
+      {
+         shape.pimpl_->do_draw();
+      }
+
+      friend void free_translate( Shape& shape, Point const& offset )
+      {
+         shape.unshare().do_translate( offset );
+      }
+
+      struct Concept
+      {
+         Concept() = default;
+         Concept( Concept const& ) noexcept {}  // A copy is not shared (yet)
+         Concept& operator=( Concept const& ) = delete;
+
+         virtual ~Concept() = default;
+         virtual void do_draw() const = 0;
+         virtual void do_translate( Point const& offset ) = 0;
+         virtual std::unique_ptr<Concept> clone() const = 0;
+
+         void acquire() const noexcept { references_.fetch_add( 1UL, std::memory_order_relaxed ); }
+
+         void release() const noexcept
+         {
+            if( references_.fetch_sub( 1UL, std::memory_order_acq_rel ) == 1UL ) delete this;
+         }
+
+         bool unique() const noexcept { return references_.load( std::memory_order_acquire ) == 1UL; }
+
+         mutable std::atomic<size_t> references_{ 1UL };
+      };
+
+      template< typename ShapeT >
+      struct Model final : public Concept
+      {
+         explicit Model( ShapeT const& shape )
+            : shape_( shape )
+         {}
+
+         void do_draw() const final { free_draw( shape_ ); }
+         void do_translate( Point const& offset ) final { free_translate( shape_, offset ); }
+         std::unique_ptr<Concept> clone() const final { return std::make_unique<Model>(*this); }
+
+         ShapeT shape_;
+      };
+
+      // Gives this shape its own model, which can be modified without affecting other shapes
+      Concept& unshare()
+      {
+         if( !pimpl_->unique() ) {
+            std::unique_ptr<Concept> copy( pimpl_->clone() );
+            pimpl_->release();
+            pimpl_ = copy.release();
+         }
+         return *pimpl_;
+      }
+
+      Concept* pimpl_;
+   };
+
+} // namespace copy_on_write_solution
+#endif
+
+
+//---- <Traits.h> ---------------------------------------------------------------------------------
+
+// The state of an animal, which (in contrast to the animals of 'Prototype.cpp') is expensive to
+// copy: The name requires a dynamic allocation, the genome is 128 bytes
+struct Traits
+{
+   std::string name;
+   std::array<float,32> genome{};
+};
+
+// Instead of making a sound, an animal accumulates a checksum (see 'free_draw()')
+void free_sound( Traits const& traits )
+{
+   canvas += static_cast<double>( traits.name.size() ) + traits.genome.front() + traits.genome.back();
+}
+
+
+#if BENCHMARK_EAGER_PROTOTYPE_SOLUTION
+namespace eager_prototype_solution {
+
+   // The 'Animal' of 'Prototype.cpp': Every clone copies the complete state of its prototype
+   class Animal
+   {
+    public:
+      virtual ~Animal() = default;
+      virtual void makeSound() const = 0;
+      virtual void mutate( size_t gene, float delta ) = 0;
+      virtual std::unique_ptr<Animal> clone() const = 0;
+   };
+
+   class Dog : public Animal
+   {
+    public:
+      explicit Dog( Traits const& traits ) : traits_( traits ) {}
+
+      void makeSound() const override { free_sound( traits_ ); }
+      void mutate( size_t gene, float delta ) override { traits_.genome[gene] += delta; }
+      std::unique_ptr<Animal> clone() const override { return std::make_unique<Dog>( *this ); }
+
+    private:
+      Traits traits_;
+   };
+
+   class Cat : public Animal
+   {
+    public:
+      explicit Cat( Traits const& traits ) : traits_( traits ) {}
+
+      void makeSound() const override { free_sound( traits_ ); }
+      void mutate( size_t gene, float delta ) override { traits_.genome[gene] -= delta; }
+      std::unique_ptr<Animal> clone() const override { return std::make_unique<Cat>( *this ); }
+
+    private:
+      Traits traits_;
+   };
+
+} // namespace eager_prototype_solution
+#endif
+
+
+#if BENCHMARK_COPY_ON_WRITE_PROTOTYPE_SOLUTION
+namespace copy_on_write_prototype_solution {
+
+   // The traits of an animal, which are shared by a prototype and all its clones. A copy only
+   // increments the reference count, the traits are copied when shared traits are modified for
+   // the first time. As for the copy-on-write 'Shape', a single animal must not be modified by
+   // one thread while it is cloned by another thread.
+   class SharedTraits
+   {
+    public:
+      explicit SharedTraits( Traits const& traits )
+         : traits_( std::make_shared<Traits>( traits ) )
+      {}
+
+      Traits const& get() const { return *traits_; }
+
+      Traits& modify()
+      {
+         if( traits_.use_count() > 1L ) {
+            traits_ = std::make_shared<Traits>( *traits_ );
+         }
+         return *traits_;
+      }
+
+    private:
+      std::shared_ptr<Traits> traits_;
+   };
+
+   // The 'Animal' of 'Prototype.cpp': A clone only shares the state of its prototype
+   class Animal
+   {
+    public:
+      virtual ~Animal() = default;
+      virtual void makeSound() const = 0;
+      virtual void mutate( size_t gene, float delta ) = 0;
+      virtual std::unique_ptr<Animal> clone() const = 0;
+   };
+
+   class Dog : public Animal
+   {
+    public:
+      explicit Dog( Traits const& traits ) : traits_( traits ) {}
+
+      void makeSound() const override { free_sound( traits_.get() ); }
+      void mutate( size_t gene, float delta ) override { traits_.modify().genome[gene] += delta; }
+      std::unique_ptr<Animal> clone() const override { return std::make_unique<Dog>( *this ); }
+
+    private:
+      SharedTraits traits_;
+   };
+
+   class Cat : public Animal
+   {
+    public:
+      explicit Cat( Traits const& traits ) : traits_( traits ) {}
+
+      void makeSound() const override { free_sound( traits_.get() ); }
+      void mutate( size_t gene, float delta ) override { traits_.modify().genome[gene] -= delta; }
+      std::unique_ptr<Animal> clone() const override { return std::make_unique<Cat>( *this ); }
+
+    private:
+      SharedTraits traits_;
+   };
+
+} // namespace copy_on_write_prototype_solution
+#endif
+
+
+//---- Benchmark ----------------------------------------------------------------------------------
+
+// The input of all solutions: The initial scene and the shapes modified in every frame
+struct Workload
+{
+   struct Shape { bool circle; double size; Point center; };
+
+   std::vector<Shape> scene;
+   std::vector<size_t> modified;  // Indices of the modified shapes ('mutations' per frame)
+};
+
+Workload generate_workload( size_t mutations, unsigned int seed )
+{
+   std::mt19937 rng{ seed };
+   std::bernoulli_distribution circle( 0.5 );
+   std::uniform_real_distribution<double> size( 0.5, 5.0 );
+   std::uniform_real_distribution<double> coordinate( -100.0, 100.0 );
+   std::uniform_int_distribution<size_t> index( 0UL, scene_size-1UL );
+
+   Workload workload{};
+   for( size_t i=0UL; i<scene_size; ++i ) {
+      workload.scene.push_back( Workload::Shape{ circle(rng), size(rng), Point{ coordinate(rng), coordinate(rng) } } );
+   }
+   for( size_t i=0UL; i<frames*mutations; ++i ) {
+      workload.modified.push_back( index(rng) );
+   }
+   return workload;
+}
+
+
+// Prints the time per frame and the checksum of a single run
+void report( double seconds )
+{
+   // The formatting flags are set on a local stream to leave 'std::cout' unchanged
+   std::ostringstream os;
+   os << std::setw(16) << std::setprecision(4) << seconds/frames*1E6
+      << " (" << std::setw(12) << std::setprecision(6) << canvas << ")";
+   std::cout << os.str();
+}
+
+
+// Every frame takes a snapshot of the scene for the undo history, modifies a few shapes of the
+// scene, and draws the snapshot
+template< typename Shape >
+void benchmark( Workload const& workload, size_t mutations )
+{
+   std::vector<Shape> scene;
+   scene.reserve( workload.scene.size() );
+   for( auto const& s : workload.scene ) {
+      if( s.circle ) scene.emplace_back( Circle{ s.size, s.center } );
+      else scene.emplace_back( Square{ s.size, s.center } );
+   }
+
+   std::vector< std::vector<Shape> > history( history_size );
+   canvas = 0.0;
+
+   std::chrono::time_point<std::chrono::high_resolution_clock> start, end;
+   start = std::chrono::high_resolution_clock::now();
+
+   for( size_t frame=0UL; frame<frames; ++frame )
+   {
+      auto& snapshot( history[frame % history_size] );
+      snapshot = scene;
+
+      for( size_t m=frame*mutations; m<(frame+1UL)*mutations; ++m ) {
+         free_translate( scene[workload.modified[m]], Point{ 0.5, 0.25 } );
+      }
+
+      for( auto const& shape : snapshot ) {
+         free_draw( shape );
+      }
+   }
+
+   end = std::chrono::high_resolution_clock::now();
+   std::chrono::duration<double> const elapsedTime( end - start );
+   report( elapsedTime.count() );
+}
+
+
+// Every frame clones a herd of animals from two prototypes, mutates a few animals of the herd,
+// and lets all animals make their sound. The circles of the scene select the dog prototype.
+template< typename Dog, typename Cat >
+void benchmark_prototype( Workload const& workload, size_t mutations )
+{
+   Dog const dog( Traits{ "Canis lupus familiaris", {} } );
+   Cat const cat( Traits{ "Felis silvestris catus", {} } );
+
+   std::vector< decltype( dog.clone() ) > herd( workload.scene.size() );
+   canvas = 0.0;
+
+   std::chrono::time_point<std::chrono::high_resolution_clock> start, end;
+   start = std::chrono::high_resolution_clock::now();
+
+   for( size_t frame=0UL; frame<frames; ++frame )
+   {
+      for( size_t i=0UL; i<herd.size(); ++i ) {
+         herd[i] = workload.scene[i].circle ? dog.clone() : cat.clone();
+      }
+
+      for( size_t m=frame*mutations; m<(frame+1UL)*mutations; ++m ) {
+         herd[workload.modified[m]]->mutate( m % 32UL, 0.5F );
+      }
+
+      for( auto const& animal : herd ) {
+         animal->makeSound();
+      }
+   }
+
+   end = std::chrono::high_resolution_clock::now();
+   std::chrono::duration<double> const elapsedTime( end - start );
+   report( elapsedTime.count() );
+}
+
+
+int main()
+{
+   std::random_device rd{};
+   unsigned int const seed( rd() );
+
+   std::cout << "\n Microseconds per frame (and checksum) for a scene of " << scene_size << " shapes\n"
+             << "\n Mutations"
+#if BENCHMARK_DEEP_COPY_SOLUTION
+             << std::setw(31) << "Deep copy"
+#endif
+#if BENCHMARK_COPY_ON_WRITE_SOLUTION
+             << std::setw(31) << "Copy-on-write"
+#endif
+             << "\n";
+
+   for( size_t mutations : { 0UL, 1UL, 10UL, 100UL, scene_size } )
+   {
+      Workload const workload( generate_workload( mutations, seed ) );
+
+      std::cout << " " << std::setw(9) << mutations;
+
+#if BENCHMARK_DEEP_COPY_SOLUTION
+      benchmark<deep_copy_solution::Shape>( workload, mutations );
+#endif
+
+#if BENCHMARK_COPY_ON_WRITE_SOLUTION
+      benchmark<copy_on_write_solution::Shape>( workload, mutations );
+#endif
+
+      std::cout << "\n";
+   }
+
+   std::cout << "\n Microseconds per frame (and checksum) for a herd of " << scene_size << " clones\n"
+             << "\n Mutations"
+#if BENCHMARK_EAGER_PROTOTYPE_SOLUTION
+             << std::setw(31) << "Eager clone"
+#endif
+#if BENCHMARK_COPY_ON_WRITE_PROTOTYPE_SOLUTION
+             << std::setw(31) << "Copy-on-write clone"
+#endif
+             << "\n";
+
+   for( size_t mutations : { 0UL, 1UL, 10UL, 100UL, scene_size } )
+   {
+      Workload const workload( generate_workload( mutations, seed ) );
+
+      std::cout << " " << std::setw(9) << mutations;
+
+#if BENCHMARK_EAGER_PROTOTYPE_SOLUTION
+      benchmark_prototype<eager_prototype_solution::Dog,eager_prototype_solution::Cat>( workload, mutations );
+#endif
+
+#if BENCHMARK_COPY_ON_WRITE_PROTOTYPE_SOLUTION
+      benchmark_prototype<copy_on_write_prototype_solution::Dog,copy_on_write_prototype_solution::Cat>( workload, mutations );
+#endif
+
+      std::cout << "\n";
+   }
+
+   std::cout << std::endl;
+
+   return EXIT_SUCCESS;
+}
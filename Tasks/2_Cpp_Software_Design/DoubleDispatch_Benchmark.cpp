@@ -0,0 +1,618 @@
+/**************************************************************************************************
+*
+* \file DoubleDispatch_Benchmark.cpp
+* \brief C++ Training - Benchmark for Multiple Dispatch (Double Visitation) on Shape Pairs
+*
+* Copyright (C) 2015-2023 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#define BENCHMARK_STD_VARIANT_SOLUTION 1
+#define BENCHMARK_CYCLIC_VISITOR_SOLUTION 1
+#define BENCHMARK_TYPE_ERASURE_SOLUTION 1
+
+
+#include <array>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+
+struct Vector2D
+{
+   double x{};
+   double y{};
+};
+
+Vector2D operator-( Vector2D const& a, Vector2D const& b )
+{
+   return Vector2D{ a.x-b.x, a.y-b.y };
+}
+
+
+//=================================================================================================
+//
+//  MULTIPLE DISPATCH ENGINE
+//
+//=================================================================================================
+
+namespace multiple_dispatch {
+
+   template< typename... Ts >
+   struct TypeList
+   {};
+
+
+   template< typename T, typename... Ts >
+   constexpr size_t index_of( TypeList<Ts...> )
+   {
+      constexpr bool matches[]{ std::is_same_v<T,Ts>... };
+
+      for( size_t i=0UL; i<sizeof...(Ts); ++i ) {
+         if( matches[i] ) return i;
+      }
+      return sizeof...(Ts);
+   }
+
+
+   // The 'Accessor' decouples the jump table from the representation of the shapes. It has to
+   // provide the dense type index of an object ('index()') and access to the concrete type
+   // ('get<T>()'), which is only ever called with the type matching the index.
+   template< typename Accessor, typename F, typename Object, typename... Ts >
+   struct JumpTable2D
+   {
+      static constexpr size_t N = sizeof...(Ts);
+
+      using Types  = std::tuple<Ts...>;
+      using First  = std::tuple_element_t<0UL,Types>;
+      using Result = std::invoke_result_t<F&,First const&,First const&>;
+      using Entry  = Result (*)( F&, Object const&, Object const& );
+
+      template< size_t I >
+      static Result entry( F& f, Object const& a, Object const& b )
+      {
+         using A = std::tuple_element_t<I/N,Types>;
+         using B = std::tuple_element_t<I%N,Types>;
+         return f( Accessor::template get<A>( a ), Accessor::template get<B>( b ) );
+      }
+
+      template< size_t... Is >
+      static constexpr std::array<Entry,N*N> make( std::index_sequence<Is...> )
+      {
+         return { &entry<Is>... };
+      }
+
+      static constexpr std::array<Entry,N*N> table{ make( std::make_index_sequence<N*N>{} ) };
+   };
+
+
+   // Resolves both dynamic types with a single indirect jump through a table of all N*N
+   // combinations, which is generated at compile time.
+   template< typename Accessor, typename... Ts, typename F, typename Object >
+   decltype(auto) dispatch( TypeList<Ts...>, F&& f, Object const& a, Object const& b )
+   {
+      using Table = JumpTable2D< Accessor, std::remove_reference_t<F>, Object, Ts... >;
+      return Table::table[ Accessor::index( a )*Table::N + Accessor::index( b ) ]( f, a, b );
+   }
+
+} // namespace multiple_dispatch
+
+
+//=================================================================================================
+//
+//  GEOMETRY
+//
+//=================================================================================================
+
+namespace geometry {
+
+   struct Circle
+   {
+      double radius{};
+      Vector2D center{};
+   };
+
+   struct Ellipse
+   {
+      double radius1{};
+      double radius2{};
+      Vector2D center{};
+   };
+
+   struct Square
+   {
+      double side{};
+      Vector2D center{};
+   };
+
+   struct Rectangle
+   {
+      double width{};
+      double height{};
+      Vector2D center{};
+   };
+
+   struct Pentagon
+   {
+      double side{};
+      Vector2D center{};
+   };
+
+   struct Hexagon
+   {
+      double side{};
+      Vector2D center{};
+   };
+
+
+   using ShapeTypes = multiple_dispatch::TypeList<Circle,Ellipse,Square,Rectangle,Pentagon,Hexagon>;
+
+
+   double boundingRadius( Circle const& c )    { return c.radius; }
+   double boundingRadius( Ellipse const& e )   { return std::max( e.radius1, e.radius2 ); }
+   double boundingRadius( Square const& s )    { return 0.7071067811865476 * s.side; }
+   double boundingRadius( Rectangle const& r ) { return 0.5 * std::sqrt( r.width*r.width + r.height*r.height ); }
+   double boundingRadius( Pentagon const& p )  { return 0.8506508083520400 * p.side; }
+   double boundingRadius( Hexagon const& h )   { return h.side; }
+
+   Vector2D halfExtents( Square const& s )    { return Vector2D{ 0.5*s.side, 0.5*s.side }; }
+   Vector2D halfExtents( Rectangle const& r ) { return Vector2D{ 0.5*r.width, 0.5*r.height }; }
+
+   template< typename T >
+   concept Box = std::is_same_v<T,Square> || std::is_same_v<T,Rectangle>;
+
+
+   // The intersection kernel. Pairs without a dedicated test fall back to a conservative test
+   // based on the bounding circles of both shapes.
+   struct Intersect
+   {
+      template< typename A, typename B >
+      bool operator()( A const& a, B const& b ) const
+      {
+         Vector2D const d( a.center - b.center );
+         double const r( boundingRadius( a ) + boundingRadius( b ) );
+         return d.x*d.x + d.y*d.y <= r*r;
+      }
+
+      template< Box A, Box B >
+      bool operator()( A const& a, B const& b ) const
+      {
+         Vector2D const d( a.center - b.center );
+         Vector2D const ea( halfExtents( a ) );
+         Vector2D const eb( halfExtents( b ) );
+         return std::abs( d.x ) <= ea.x+eb.x && std::abs( d.y ) <= ea.y+eb.y;
+      }
+
+      template< Box B >
+      bool operator()( Circle const& c, B const& b ) const
+      {
+         Vector2D const d( c.center - b.center );
+         Vector2D const e( halfExtents( b ) );
+         double const dx( d.x - std::clamp( d.x, -e.x, e.x ) );
+         double const dy( d.y - std::clamp( d.y, -e.y, e.y ) );
+         return dx*dx + dy*dy <= c.radius*c.radius;
+      }
+
+      template< Box A >
+      bool operator()( A const& a, Circle const& c ) const
+      {
+         return (*this)( c, a );
+      }
+   };
+
+} // namespace geometry
+
+
+#if BENCHMARK_STD_VARIANT_SOLUTION
+namespace std_variant_solution {
+
+   using namespace geometry;
+
+   template< typename... Ts >
+   std::variant<Ts...> as_variant( multiple_dispatch::TypeList<Ts...> );
+
+   using Shape = decltype( as_variant( ShapeTypes{} ) );
+
+   using Shapes = std::vector<Shape>;
+
+
+   // Two nested single visits: two indirect jumps per pair
+   bool intersects_nested( Shape const& a, Shape const& b )
+   {
+      return std::visit( [&b]( auto const& sa ) {
+         return std::visit( [&sa]( auto const& sb ) { return Intersect{}( sa, sb ); }, b );
+      }, a );
+   }
+
+   // The multi-variant overload of 'std::visit()'
+   bool intersects_multi( Shape const& a, Shape const& b )
+   {
+      return std::visit( Intersect{}, a, b );
+   }
+
+   struct Accessor
+   {
+      static size_t index( Shape const& s ) { return s.index(); }
+
+      template< typename T >
+      static T const& get( Shape const& s ) { return *std::get_if<T>( &s ); }
+   };
+
+   bool intersects_table( Shape const& a, Shape const& b )
+   {
+      return multiple_dispatch::dispatch<Accessor>( ShapeTypes{}, Intersect{}, a, b );
+   }
+
+   struct Factory
+   {
+      template< typename T >
+      Shape operator()( T const& shape ) const { return shape; }
+   };
+
+} // namespace std_variant_solution
+#endif
+
+
+#if BENCHMARK_CYCLIC_VISITOR_SOLUTION
+namespace cyclic_visitor_solution {
+
+   using namespace geometry;
+
+   template< typename T >
+   struct ShapeNode;
+
+
+   struct Visitor
+   {
+      virtual ~Visitor() = default;
+
+      virtual void visit( ShapeNode<Circle> const& ) const = 0;
+      virtual void visit( ShapeNode<Ellipse> const& ) const = 0;
+      virtual void visit( ShapeNode<Square> const& ) const = 0;
+      virtual void visit( ShapeNode<Rectangle> const& ) const = 0;
+      virtual void visit( ShapeNode<Pentagon> const& ) const = 0;
+      virtual void visit( ShapeNode<Hexagon> const& ) const = 0;
+   };
+
+
+   struct Shape
+   {
+      explicit Shape( size_t i )
+         : index{ i }
+      {}
+
+      virtual ~Shape() {}
+      virtual void accept( Visitor const& v ) const = 0;
+
+      size_t index{};  // The dense type index, which is only required for the jump table
+   };
+
+
+   template< typename T >
+   struct ShapeNode final : public Shape
+   {
+      explicit ShapeNode( T const& s )
+         : Shape{ multiple_dispatch::index_of<T>( ShapeTypes{} ) }
+         , shape{ s }
+      {}
+
+      void accept( Visitor const& v ) const override { v.visit(*this); }
+
+      T shape;
+   };
+
+
+   template< typename A >
+   struct IntersectWith final : public Visitor
+   {
+      IntersectWith( A const& s, bool& r ) : a{ s }, result{ r } {}
+
+      void visit( ShapeNode<Circle> const& b ) const override { result = Intersect{}( a, b.shape ); }
+      void visit( ShapeNode<Ellipse> const& b ) const override { result = Intersect{}( a, b.shape ); }
+      void visit( ShapeNode<Square> const& b ) const override { result = Intersect{}( a, b.shape ); }
+      void visit( ShapeNode<Rectangle> const& b ) const override { result = Intersect{}( a, b.shape ); }
+      void visit( ShapeNode<Pentagon> const& b ) const override { result = Intersect{}( a, b.shape ); }
+      void visit( ShapeNode<Hexagon> const& b ) const override { result = Intersect{}( a, b.shape ); }
+
+      A const& a;
+      bool& result;
+   };
+
+
+   struct IntersectFirst final : public Visitor
+   {
+      IntersectFirst( Shape const& s, bool& r ) : b{ s }, result{ r } {}
+
+      void visit( ShapeNode<Circle> const& a ) const override { b.accept( IntersectWith{ a.shape, result } ); }
+      void visit( ShapeNode<Ellipse> const& a ) const override { b.accept( IntersectWith{ a.shape, result } ); }
+      void visit( ShapeNode<Square> const& a ) const override { b.accept( IntersectWith{ a.shape, result } ); }
+      void visit( ShapeNode<Rectangle> const& a ) const override { b.accept( IntersectWith{ a.shape, result } ); }
+      void visit( ShapeNode<Pentagon> const& a ) const override { b.accept( IntersectWith{ a.shape, result } ); }
+      void visit( ShapeNode<Hexagon> const& a ) const override { b.accept( IntersectWith{ a.shape, result } ); }
+
+      Shape const& b;
+      bool& result;
+   };
+
+
+   using Shapes = std::vector< std::unique_ptr<Shape> >;
+
+
+   // Classic double visitation: two 'accept()' and two 'visit()' calls per pair
+   bool intersects_nested( std::unique_ptr<Shape> const& a, std::unique_ptr<Shape> const& b )
+   {
+      bool result{};
+      a->accept( IntersectFirst{ *b, result } );
+      return result;
+   }
+
+   struct Accessor
+   {
+      static size_t index( Shape const& s ) { return s.index; }
+
+      template< typename T >
+      static T const& get( Shape const& s ) { return static_cast<ShapeNode<T> const&>( s ).shape; }
+   };
+
+   bool intersects_table( std::unique_ptr<Shape> const& a, std::unique_ptr<Shape> const& b )
+   {
+      return multiple_dispatch::dispatch<Accessor>( ShapeTypes{}, Intersect{}, *a, *b );
+   }
+
+   struct Factory
+   {
+      template< typename T >
+      std::unique_ptr<Shape> operator()( T const& shape ) const { return std::make_unique<ShapeNode<T>>( shape ); }
+   };
+
+} // namespace cyclic_visitor_solution
+#endif
+
+
+#if BENCHMARK_TYPE_ERASURE_SOLUTION
+namespace type_erasure_solution {
+
+   using namespace geometry;
+
+   class Shape
+   {
+    public:
+      template< typename ShapeT >
+      Shape( ShapeT const& shape )
+         : pimpl_( std::make_unique<Model<ShapeT>>( shape ) )
+         , index_( multiple_dispatch::index_of<ShapeT>( ShapeTypes{} ) )
+      {}
+
+      Shape( Shape const& other )
+         : pimpl_( other.pimpl_->clone() )
+         , index_( other.index_ )
+      {}
+
+      Shape& operator=( Shape const& other )
+      {
+         // Copy-and-swap idiom
+         Shape tmp( other );
+         std::swap( pimpl_, tmp.pimpl_ );
+         std::swap( index_, tmp.index_ );
+         return *this;
+      }
+
+      ~Shape() = default;
+      Shape( Shape&& ) = default;
+      Shape& operator=( Shape&& ) = default;
+
+    private:
+      // Classic double dispatch through the virtual functions of the concept
+      friend bool intersects_nested( Shape const& a, Shape const& b )
+      {
+         return a.pimpl_->intersects( *b.pimpl_ );
+      }
+
+      friend struct Accessor;
+
+      struct Concept
+      {
+         virtual ~Concept() = default;
+         virtual bool intersects( Concept const& other ) const = 0;
+         virtual bool intersectsWith( Circle const& ) const = 0;
+         virtual bool intersectsWith( Ellipse const& ) const = 0;
+         virtual bool intersectsWith( Square const& ) const = 0;
+         virtual bool intersectsWith( Rectangle const& ) const = 0;
+         virtual bool intersectsWith( Pentagon const& ) const = 0;
+         virtual bool intersectsWith( Hexagon const& ) const = 0;
+         virtual std::unique_ptr<Concept> clone() const = 0;
+      };
+
+      template< typename ShapeT >
+      struct Model final : public Concept
+      {
+         explicit Model( ShapeT const& shape )
+            : shape_( shape )
+         {}
+
+         bool intersects( Concept const& other ) const final { return other.intersectsWith( shape_ ); }
+         bool intersectsWith( Circle const& a ) const final { return Intersect{}( a, shape_ ); }
+         bool intersectsWith( Ellipse const& a ) const final { return Intersect{}( a, shape_ ); }
+         bool intersectsWith( Square const& a ) const final { return Intersect{}( a, shape_ ); }
+         bool intersectsWith( Rectangle const& a ) const final { return Intersect{}( a, shape_ ); }
+         bool intersectsWith( Pentagon const& a ) const final { return Intersect{}( a, shape_ ); }
+         bool intersectsWith( Hexagon const& a ) const final { return Intersect{}( a, shape_ ); }
+         std::unique_ptr<Concept> clone() const final { return std::make_unique<Model>(*this); }
+
+         ShapeT shape_;
+      };
+
+      std::unique_ptr<Concept> pimpl_;
+      size_t index_{};  // The dense type index, which is only required for the jump table
+   };
+
+   bool intersects_nested( Shape const& a, Shape const& b );
+
+   struct Accessor
+   {
+      static size_t index( Shape const& s ) { return s.index_; }
+
+      template< typename T >
+      static T const& get( Shape const& s ) { return static_cast<Shape::Model<T> const&>( *s.pimpl_ ).shape_; }
+   };
+
+   bool intersects_table( Shape const& a, Shape const& b )
+   {
+      return multiple_dispatch::dispatch<Accessor>( ShapeTypes{}, Intersect{}, a, b );
+   }
+
+   using Shapes = std::vector<Shape>;
+
+   struct Factory
+   {
+      template< typename T >
+      Shape operator()( T const& shape ) const { return shape; }
+   };
+
+} // namespace type_erasure_solution
+#endif
+
+
+constexpr size_t cells          ( 1000UL );
+constexpr size_t shapes_per_cell( 32UL );
+constexpr size_t steps          ( 100UL );
+
+
+// Creates the content of all grid cells. Every cell covers the unit square, which results in a
+// realistic mix of intersecting and non-intersecting shape pairs.
+template< typename Factory >
+auto createCells( unsigned int seed, Factory factory )
+{
+   using namespace geometry;
+
+   using Element = decltype( factory( Circle{} ) );
+
+   std::mt19937 rng{ seed };
+   std::uniform_int_distribution<int> int_dist( 1, 6 );
+   std::uniform_real_distribution<double> real_dist( 0.0, 1.0 );
+   std::uniform_real_distribution<double> size_dist( 0.01, 0.25 );
+
+   std::vector< std::vector<Element> > grid( cells );
+
+   for( auto& cell : grid )
+   {
+      while( cell.size() < shapes_per_cell )
+      {
+         int const random_value( int_dist(rng) );
+         Vector2D const center{ real_dist(rng), real_dist(rng) };
+
+         if( random_value == 1 ) {
+            cell.emplace_back( factory( Circle{ size_dist(rng), center } ) );
+         }
+         else if( random_value == 2 ) {
+            cell.emplace_back( factory( Ellipse{ size_dist(rng), size_dist(rng), center } ) );
+         }
+         else if( random_value == 3 ) {
+            cell.emplace_back( factory( Square{ size_dist(rng), center } ) );
+         }
+         else if( random_value == 4 ) {
+            cell.emplace_back( factory( Rectangle{ size_dist(rng), size_dist(rng), center } ) );
+         }
+         else if( random_value == 5 ) {
+            cell.emplace_back( factory( Pentagon{ size_dist(rng), center } ) );
+         }
+         else {
+            cell.emplace_back( factory( Hexagon{ size_dist(rng), center } ) );
+         }
+      }
+   }
+
+   return grid;
+}
+
+
+// Runs the pairwise intersection test on all shape pairs of all grid cells
+template< auto intersects, typename Grid >
+void benchmark( char const* label, Grid const& grid )
+{
+   size_t count{};
+
+   std::chrono::time_point<std::chrono::high_resolution_clock> start, end;
+   start = std::chrono::high_resolution_clock::now();
+
+   for( size_t s=0UL; s<steps; ++s ) {
+      for( auto const& cell : grid ) {
+         for( size_t i=0UL; i<cell.size(); ++i ) {
+            for( size_t j=i+1UL; j<cell.size(); ++j ) {
+               count += static_cast<size_t>( intersects( cell[i], cell[j] ) );
+            }
+         }
+      }
+   }
+
+   end = std::chrono::high_resolution_clock::now();
+   std::chrono::duration<double> const elapsedTime( end - start );
+   double const seconds( elapsedTime.count() );
+
+   // The formatting flags are set on a local stream to leave 'std::cout' unchanged
+   std::ostringstream os;
+   os << " " << std::left << std::setw(38) << label << ": " << seconds << "s"
+      << "  (" << count/steps << " intersections per step)\n";
+   std::cout << os.str();
+}
+
+
+int main()
+{
+   std::random_device rd{};
+   unsigned int const seed( rd() );
+
+   std::cout << std::endl;
+
+#if BENCHMARK_STD_VARIANT_SOLUTION
+   {
+      using namespace std_variant_solution;
+
+      auto const grid( createCells( seed, Factory{} ) );
+
+      benchmark<intersects_nested>( "std::variant (nested std::visit)", grid );
+      benchmark<intersects_multi>( "std::variant (std::visit on two)", grid );
+      benchmark<intersects_table>( "std::variant (2D jump table)", grid );
+   }
+#endif
+
+#if BENCHMARK_CYCLIC_VISITOR_SOLUTION
+   {
+      using namespace cyclic_visitor_solution;
+
+      auto const grid( createCells( seed, Factory{} ) );
+
+      benchmark<intersects_nested>( "Cyclic visitor (double visitation)", grid );
+      benchmark<intersects_table>( "Cyclic visitor (2D jump table)", grid );
+   }
+#endif
+
+#if BENCHMARK_TYPE_ERASURE_SOLUTION
+   {
+      using namespace type_erasure_solution;
+
+      auto const grid( createCells( seed, Factory{} ) );
+
+      benchmark<intersects_nested>( "Type erasure (double dispatch)", grid );
+      benchmark<intersects_table>( "Type erasure (2D jump table)", grid );
+   }
+#endif
+
+   std::cout << std::endl;
+
+   return EXIT_SUCCESS;
+}
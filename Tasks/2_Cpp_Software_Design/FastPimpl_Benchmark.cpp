@@ -0,0 +1,333 @@
+/**************************************************************************************************
+*
+* \file FastPimpl_Benchmark.cpp
+* \brief C++ Training - Benchmark for the Pimpl and the Fast Pimpl Idiom
+*
+* Copyright (C) 2015-2023 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#define BENCHMARK_HEAP_PIMPL 1
+#define BENCHMARK_FAST_PIMPL 1
+
+
+//---- <FastPimpl.h> ------------------------------------------------------------------------------
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// In-class storage for the implementation details of a class (the "Fast Pimpl Idiom"). The
+// 'Impl' type may be incomplete at the point of declaration, but has to be complete wherever a
+// constructor, the destructor, or an assignment operator of 'fast_pimpl' is instantiated. The
+// owning class therefore has to declare all of its special member functions and has to define
+// them (possibly as '= default') in its source file, after the definition of 'Impl'. In case
+// 'Size' or 'Align' are insufficient for 'Impl', the compilation fails with a diagnostic that
+// contains the required size and alignment ('RequiredSize' and 'RequiredAlign').
+template< typename Impl, size_t Size, size_t Align = alignof(std::max_align_t) >
+class fast_pimpl
+{
+   static_assert( std::has_single_bit( Align ), "The alignment must be a power of two" );
+
+ public:
+   template< typename... Args >
+      requires ( sizeof...(Args) != 1UL || !( std::is_same_v<std::remove_cvref_t<Args>,fast_pimpl> && ... ) )
+   explicit fast_pimpl( Args&&... args )
+   {
+      validate<sizeof(Impl),alignof(Impl)>();
+      std::construct_at( get(), std::forward<Args>(args)... );
+   }
+
+   ~fast_pimpl()
+   {
+      std::destroy_at( get() );
+   }
+
+   fast_pimpl( fast_pimpl const& other )
+   {
+      validate<sizeof(Impl),alignof(Impl)>();
+      std::construct_at( get(), *other );
+   }
+
+   fast_pimpl& operator=( fast_pimpl const& other )
+   {
+      **this = *other;
+      return *this;
+   }
+
+   fast_pimpl( fast_pimpl&& other ) noexcept( std::is_nothrow_move_constructible_v<Impl> )
+   {
+      validate<sizeof(Impl),alignof(Impl)>();
+      std::construct_at( get(), std::move(*other) );
+   }
+
+   fast_pimpl& operator=( fast_pimpl&& other ) noexcept( std::is_nothrow_move_assignable_v<Impl> )
+   {
+      **this = std::move(*other);
+      return *this;
+   }
+
+   Impl*       get()       noexcept { return std::launder( reinterpret_cast<Impl*>( buffer_.data() ) ); }
+   Impl const* get() const noexcept { return std::launder( reinterpret_cast<Impl const*>( buffer_.data() ) ); }
+
+   Impl&       operator*()       noexcept { return *get(); }
+   Impl const& operator*() const noexcept { return *get(); }
+
+   Impl*       operator->()       noexcept { return get(); }
+   Impl const* operator->() const noexcept { return get(); }
+
+ private:
+   // The required size and alignment are template arguments to make them part of the diagnostic
+   template< size_t RequiredSize, size_t RequiredAlign >
+   static constexpr void validate() noexcept
+   {
+      static_assert( RequiredSize <= Size, "The size of the buffer is insufficient: Increase 'Size' to 'RequiredSize'" );
+      static_assert( RequiredAlign <= Align, "The alignment of the buffer is insufficient: Increase 'Align' to 'RequiredAlign'" );
+   }
+
+   alignas(Align) std::array<std::byte,Size> buffer_;  // Not initialized!
+};
+
+
+//---- <HeapCar.h> --------------------------------------------------------------------------------
+
+//#include <memory>
+
+// The classic pimpl: The implementation details are allocated dynamically
+class HeapCar
+{
+ public:
+   explicit HeapCar( int power );
+   ~HeapCar();
+
+   HeapCar( HeapCar const& other );
+   HeapCar& operator=( HeapCar const& other );
+
+   HeapCar( HeapCar&& other ) noexcept;
+   HeapCar& operator=( HeapCar&& other ) noexcept;
+
+   void drive( double distance );
+   double mileage() const;
+
+ private:
+   struct Impl;
+
+   std::unique_ptr<Impl> pimpl_;
+};
+
+
+//---- <FastCar.h> --------------------------------------------------------------------------------
+
+//#include <FastPimpl.h>
+
+// The fast pimpl: The implementation details are stored within the object
+class FastCar
+{
+ public:
+   explicit FastCar( int power );
+   ~FastCar();
+
+   FastCar( FastCar const& other );
+   FastCar& operator=( FastCar const& other );
+
+   FastCar( FastCar&& other ) noexcept;
+   FastCar& operator=( FastCar&& other ) noexcept;
+
+   void drive( double distance );
+   double mileage() const;
+
+ private:
+   struct Impl;
+
+   fast_pimpl<Impl,56UL,8UL> pimpl_;
+};
+
+
+//---- <CarData.h> --------------------------------------------------------------------------------
+
+#include <string>
+
+// The implementation details of both cars
+struct CarData
+{
+   explicit CarData( int power ) : power_{ power } {}
+
+   void drive( double distance )
+   {
+      charge_ -= distance * 0.15 * power_ / 100.0;
+      mileage_ += distance;
+   }
+
+   int power_{};          // Power in kW
+   double charge_{ 80.0 };  // Electrical charge in kWh
+   double mileage_{};     // Distance in km
+   std::string model_{ "Gen1" };
+};
+
+
+//---- <HeapCar.cpp> ------------------------------------------------------------------------------
+
+//#include <CarData.h>
+//#include <HeapCar.h>
+
+struct HeapCar::Impl : public CarData
+{
+   using CarData::CarData;
+};
+
+HeapCar::HeapCar( int power ) : pimpl_{ std::make_unique<Impl>( power ) } {}
+HeapCar::~HeapCar() = default;
+
+HeapCar::HeapCar( HeapCar const& other ) : pimpl_{ std::make_unique<Impl>( *other.pimpl_ ) } {}
+HeapCar& HeapCar::operator=( HeapCar const& other ) { *pimpl_ = *other.pimpl_; return *this; }
+
+HeapCar::HeapCar( HeapCar&& other ) noexcept = default;
+HeapCar& HeapCar::operator=( HeapCar&& other ) noexcept = default;
+
+void HeapCar::drive( double distance ) { pimpl_->drive( distance ); }
+double HeapCar::mileage() const { return pimpl_->mileage_; }
+
+
+//---- <FastCar.cpp> ------------------------------------------------------------------------------
+
+//#include <CarData.h>
+//#include <FastCar.h>
+
+struct FastCar::Impl : public CarData
+{
+   using CarData::CarData;
+};
+
+FastCar::FastCar( int power ) : pimpl_{ power } {}
+FastCar::~FastCar() = default;
+
+FastCar::FastCar( FastCar const& other ) = default;
+FastCar& FastCar::operator=( FastCar const& other ) = default;
+
+FastCar::FastCar( FastCar&& other ) noexcept = default;
+FastCar& FastCar::operator=( FastCar&& other ) noexcept = default;
+
+void FastCar::drive( double distance ) { pimpl_->drive( distance ); }
+double FastCar::mileage() const { return pimpl_->mileage_; }
+
+
+//---- <Main.cpp> ---------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+constexpr size_t N( 1000000UL );  // Number of cars
+constexpr size_t passes( 20UL );  // Number of passes over all cars in the access benchmark
+
+
+template< typename Function >
+double measure( Function function )
+{
+   std::chrono::time_point<std::chrono::high_resolution_clock> start, end;
+   start = std::chrono::high_resolution_clock::now();
+
+   function();
+
+   end = std::chrono::high_resolution_clock::now();
+   std::chrono::duration<double> const elapsedTime( end - start );
+   return elapsedTime.count();
+}
+
+
+// Constructs and destroys 'N' cars
+template< typename Car >
+void benchmark_construction( char const* label )
+{
+   double const seconds = measure( [](){
+      std::vector<Car> cars;
+      cars.reserve( N );
+      for( size_t i=0UL; i<N; ++i ) {
+         cars.emplace_back( 100 + static_cast<int>( i % 50UL ) );
+      }
+   } );
+
+   // The formatting flags are set on a local stream to leave 'std::cout' unchanged
+   std::ostringstream os;
+   os << " " << std::left << std::setw(28) << label << ": " << seconds << "s"
+      << "  (" << std::setprecision(4) << N/seconds/1E6 << "M cars/s)\n";
+   std::cout << os.str();
+}
+
+
+// Drives all cars in several passes. Before, the cars are shuffled, which (for the heap pimpl)
+// models a container that has been reordered, grown, and shrunk many times: The cars remain
+// contiguous, but their dynamically allocated implementation details are scattered in memory.
+template< typename Car >
+void benchmark_access( char const* label, unsigned int seed )
+{
+   std::vector<Car> cars;
+   cars.reserve( N );
+   for( size_t i=0UL; i<N; ++i ) {
+      cars.emplace_back( 100 + static_cast<int>( i % 50UL ) );
+   }
+
+   std::mt19937 rng{ seed };
+   std::shuffle( begin(cars), end(cars), rng );
+
+   double total( 0.0 );
+
+   double const seconds = measure( [&](){
+      for( size_t pass=0UL; pass<passes; ++pass ) {
+         for( auto& car : cars ) {
+            car.drive( 1.0 );
+         }
+      }
+      for( auto const& car : cars ) {
+         total += car.mileage();
+      }
+   } );
+
+   std::ostringstream os;
+   os << " " << std::left << std::setw(28) << label << ": " << seconds << "s"
+      << "  (" << std::setprecision(4) << N*passes/seconds/1E6 << "M calls/s"
+      << ", total mileage = " << total << ")\n";
+   std::cout << os.str();
+}
+
+
+int main()
+{
+   std::random_device rd{};
+   unsigned int const seed( rd() );
+
+   std::cout << "\n sizeof(HeapCar) = " << sizeof(HeapCar)
+             << ", sizeof(FastCar) = " << sizeof(FastCar) << "\n";
+
+   std::cout << "\n Construction\n";
+#if BENCHMARK_HEAP_PIMPL
+   benchmark_construction<HeapCar>( "Pimpl (std::unique_ptr)" );
+#endif
+#if BENCHMARK_FAST_PIMPL
+   benchmark_construction<FastCar>( "Fast pimpl" );
+#endif
+
+   std::cout << "\n Member access\n";
+#if BENCHMARK_HEAP_PIMPL
+   benchmark_access<HeapCar>( "Pimpl (std::unique_ptr)", seed );
+#endif
+#if BENCHMARK_FAST_PIMPL
+   benchmark_access<FastCar>( "Fast pimpl", seed );
+#endif
+
+   std::cout << std::endl;
+
+   return EXIT_SUCCESS;
+}
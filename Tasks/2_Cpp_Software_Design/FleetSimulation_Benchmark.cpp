@@ -0,0 +1,430 @@
+/**************************************************************************************************
+*
+* \file FleetSimulation_Benchmark.cpp
+* \brief C++ Training - Benchmark for the Strategy and Bridge Design Patterns (Vehicle Fleet)
+*
+* Copyright (C) 2015-2023 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#define BENCHMARK_STRATEGY_SOLUTION 1
+#define BENCHMARK_SOA_SOLUTION 1
+
+
+#include <algorithm>
+#include <barrier>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <utility>
+#include <vector>
+#if defined(__linux__)
+#  include <pthread.h>
+#  include <sched.h>
+#endif
+
+
+//---- Configuration ------------------------------------------------------------------------------
+
+constexpr size_t N( 1000000UL );  // Number of vehicles
+constexpr size_t steps( 100UL );  // Number of simulated time steps
+constexpr double dt( 1.0 );  // Duration of a single time step (in s)
+
+
+//---- Physical model -----------------------------------------------------------------------------
+
+// The model of all solutions: A vehicle accelerates with the power of its engine (in kW) against
+// the air drag, as long as its battery (in kWh) is not empty
+constexpr double acceleration_per_kW( 0.001 );  // in m/s^2
+constexpr double drag( 0.0005 );  // in 1/m
+
+enum class Generation : std::uint8_t { gen1, gen2 };
+
+constexpr double max_power( Generation g ) { return g == Generation::gen1 ? 100.0 : 150.0; }
+constexpr double efficiency( Generation g ) { return g == Generation::gen1 ? 0.90 : 0.95; }
+constexpr double capacity( Generation g ) { return g == Generation::gen1 ? 0.5 : 0.8; }
+
+
+// The initial state of a vehicle
+struct VehicleSpec
+{
+   Generation generation{};
+   double throttle{};  // Fraction of the maximum power
+};
+
+std::vector<VehicleSpec> generate_specs( unsigned int seed )
+{
+   std::mt19937 rng{ seed };
+   std::bernoulli_distribution gen2( 0.5 );
+   std::uniform_real_distribution<double> throttle( 0.2, 1.0 );
+
+   std::vector<VehicleSpec> specs( N );
+   for( auto& spec : specs ) {
+      spec.generation = gen2(rng) ? Generation::gen2 : Generation::gen1;
+      spec.throttle = throttle(rng);
+   }
+   return specs;
+}
+
+
+#if BENCHMARK_STRATEGY_SOLUTION
+namespace strategy_solution {
+
+   // The layout of 'Car_Strategy.cpp': Every car is allocated individually and owns its engine
+
+   class Engine
+   {
+    public:
+      virtual ~Engine() = default;
+      virtual void start() = 0;
+      virtual void stop() = 0;
+      virtual double power( double throttle ) const = 0;  // in kW
+      virtual double efficiency() const = 0;
+   };
+
+   class Car
+   {
+    protected:
+      Car( std::unique_ptr<Engine> engine )
+         : engine_{ std::move(engine) }
+      {}
+
+    public:
+      virtual ~Car() = default;
+      virtual void drive( double duration ) = 0;
+      virtual double distance() const = 0;
+
+    protected:
+      Engine* getEngine() { return engine_.get(); }
+
+    private:
+      std::unique_ptr<Engine> engine_;
+   };
+
+   class ElectricCar : public Car
+   {
+    public:
+      ElectricCar( std::unique_ptr<Engine> engine, double charge, double throttle )
+         : Car{ std::move(engine) }
+         , charge_{ charge }
+         , throttle_{ throttle }
+      {}
+
+      void drive( double duration ) override
+      {
+         Engine* const engine( getEngine() );
+         engine->start();
+         double const power( charge_ > 0.0 ? engine->power( throttle_ ) : 0.0 );
+         speed_ += ( acceleration_per_kW*power - drag*speed_*speed_ ) * duration;
+         distance_ += speed_ * duration;
+         charge_ -= power * duration / ( 3600.0 * engine->efficiency() );
+         engine->stop();
+      }
+
+      double distance() const override { return distance_; }
+
+    private:
+      double charge_{};  // in kWh
+      double throttle_{};
+      double speed_{};  // in m/s
+      double distance_{};  // in m
+   };
+
+   class ElectricEngineGen1 : public Engine
+   {
+    public:
+      void start() override { running_ = true; }
+      void stop() override { running_ = false; }
+      double power( double throttle ) const override { return max_power( Generation::gen1 ) * throttle; }
+      double efficiency() const override { return ::efficiency( Generation::gen1 ); }
+
+    private:
+      bool running_{};
+   };
+
+   class ElectricEngineGen2 : public Engine
+   {
+    public:
+      void start() override { running_ = true; }
+      void stop() override { running_ = false; }
+      double power( double throttle ) const override { return max_power( Generation::gen2 ) * throttle; }
+      double efficiency() const override { return ::efficiency( Generation::gen2 ); }
+
+    private:
+      bool running_{};
+   };
+
+   class Fleet
+   {
+    public:
+      explicit Fleet( std::vector<VehicleSpec> const& specs )
+      {
+         cars_.reserve( specs.size() );
+         for( auto const& spec : specs ) {
+            std::unique_ptr<Engine> engine;
+            if( spec.generation == Generation::gen1 ) engine = std::make_unique<ElectricEngineGen1>();
+            else engine = std::make_unique<ElectricEngineGen2>();
+            cars_.push_back( std::make_unique<ElectricCar>( std::move(engine), capacity( spec.generation ), spec.throttle ) );
+         }
+      }
+
+      size_t size() const { return cars_.size(); }
+
+      // Advances the vehicles in the range [begin,end) by one time step
+      void step( size_t begin, size_t end, double duration )
+      {
+         for( size_t i=begin; i<end; ++i ) {
+            cars_[i]->drive( duration );
+         }
+      }
+
+      double distance() const
+      {
+         double total( 0.0 );
+         for( auto const& car : cars_ ) {
+            total += car->distance();
+         }
+         return total;
+      }
+
+    private:
+      std::vector< std::unique_ptr<Car> > cars_;
+   };
+
+} // namespace strategy_solution
+#endif
+
+
+#if BENCHMARK_SOA_SOLUTION
+namespace soa_solution {
+
+   // The state of all engines, batteries, and vehicles is stored in contiguous arrays, which are
+   // traversed in a single, branch-free (and therefore vectorizable) loop. Since 'start()' and
+   // 'stop()' of the engines don't change the simulated state, they are not represented.
+   class Fleet
+   {
+    public:
+      explicit Fleet( std::vector<VehicleSpec> const& specs )
+         : power_( specs.size() )
+         , efficiency_( specs.size() )
+         , charge_( specs.size() )
+         , speed_( specs.size() )
+         , distance_( specs.size() )
+      {
+         for( size_t i=0UL; i<specs.size(); ++i ) {
+            power_[i] = max_power( specs[i].generation ) * specs[i].throttle;
+            efficiency_[i] = efficiency( specs[i].generation );
+            charge_[i] = capacity( specs[i].generation );
+         }
+      }
+
+      size_t size() const { return power_.size(); }
+
+      // Advances the vehicles in the range [begin,end) by one time step
+      void step( size_t begin, size_t end, double duration )
+      {
+         double const* const power( power_.data() );
+         double const* const efficiency( efficiency_.data() );
+         double* const charge( charge_.data() );
+         double* const speed( speed_.data() );
+         double* const distance( distance_.data() );
+
+         for( size_t i=begin; i<end; ++i ) {
+            double const p( charge[i] > 0.0 ? power[i] : 0.0 );
+            speed[i] += ( acceleration_per_kW*p - drag*speed[i]*speed[i] ) * duration;
+            distance[i] += speed[i] * duration;
+            charge[i] -= p * duration / ( 3600.0 * efficiency[i] );
+         }
+      }
+
+      double distance() const
+      {
+         double total( 0.0 );
+         for( double d : distance_ ) {
+            total += d;
+         }
+         return total;
+      }
+
+    private:
+      // Engines
+      std::vector<double> power_;  // Power at the current throttle (in kW)
+      std::vector<double> efficiency_;
+
+      // Batteries
+      std::vector<double> charge_;  // in kWh
+
+      // Vehicles
+      std::vector<double> speed_;  // in m/s
+      std::vector<double> distance_;  // in m
+   };
+
+} // namespace soa_solution
+#endif
+
+
+//---- Thread pool --------------------------------------------------------------------------------
+
+// A fixed set of threads, each pinned to one hardware thread (see 'ParallelMembers.cpp').
+// 'execute()' runs the given task on all threads and returns as soon as all threads are done.
+class Workers
+{
+ public:
+   explicit Workers( size_t n )
+      : sync_( static_cast<std::ptrdiff_t>( n+1UL ) )
+   {
+      threads_.reserve( n );
+      for( size_t t=0UL; t<n; ++t ) {
+         threads_.emplace_back( [this,t](){ run( t ); } );
+      }
+   }
+
+   ~Workers()
+   {
+      task_ = nullptr;
+      sync_.arrive_and_wait();
+   }
+
+   size_t size() const { return threads_.size(); }
+
+   void execute( std::function<void(size_t)> const& task )
+   {
+      task_ = &task;
+      sync_.arrive_and_wait();  // Start
+      sync_.arrive_and_wait();  // Finish
+   }
+
+ private:
+   void run( size_t t )
+   {
+      pin( t );
+      while( true ) {
+         sync_.arrive_and_wait();
+         if( !task_ ) return;
+         (*task_)( t );
+         sync_.arrive_and_wait();
+      }
+   }
+
+   static void pin( [[maybe_unused]] size_t t )
+   {
+#if defined(__linux__)
+      cpu_set_t set;
+      CPU_ZERO( &set );
+      CPU_SET( t % std::max( std::thread::hardware_concurrency(), 1U ), &set );
+      pthread_setaffinity_np( pthread_self(), sizeof(set), &set );
+#endif
+   }
+
+   std::function<void(size_t)> const* task_{};
+   std::barrier<> sync_;
+   std::vector<std::jthread> threads_;  // Declared last to be joined first
+};
+
+
+//---- Benchmark ----------------------------------------------------------------------------------
+
+// Simulates all time steps. With 'threads == 0', the simulation runs on the calling thread,
+// otherwise every step is distributed among the threads of a thread pool.
+template< typename Fleet >
+void benchmark( std::vector<VehicleSpec> const& specs, size_t threads )
+{
+   Fleet fleet( specs );
+
+   std::chrono::time_point<std::chrono::high_resolution_clock> start, end;
+
+   if( threads == 0UL )
+   {
+      start = std::chrono::high_resolution_clock::now();
+
+      for( size_t s=0UL; s<steps; ++s ) {
+         fleet.step( 0UL, fleet.size(), dt );
+      }
+
+      end = std::chrono::high_resolution_clock::now();
+   }
+   else
+   {
+      Workers workers( threads );
+      size_t const chunk( ( fleet.size() + threads - 1UL ) / threads );
+
+      std::function<void(size_t)> const step = [&]( size_t t ){
+         fleet.step( std::min( t*chunk, fleet.size() ), std::min( (t+1UL)*chunk, fleet.size() ), dt );
+      };
+
+      start = std::chrono::high_resolution_clock::now();
+
+      for( size_t s=0UL; s<steps; ++s ) {
+         workers.execute( step );
+      }
+
+      end = std::chrono::high_resolution_clock::now();
+   }
+
+   std::chrono::duration<double> const elapsedTime( end - start );
+   double const seconds( elapsedTime.count() );
+   size_t const cores( std::max( threads, size_t{1} ) );
+
+   // The formatting flags are set on a local stream to leave 'std::cout' unchanged
+   std::ostringstream os;
+   os << std::setw(16) << std::setprecision(4) << fleet.size()*steps/seconds/cores/1E6
+      << " (" << std::setw(9) << std::setprecision(6) << fleet.distance()/1E3 << " km)";
+   std::cout << os.str();
+}
+
+
+int main()
+{
+   std::random_device rd{};
+   unsigned int const seed( rd() );
+
+   std::vector<VehicleSpec> const specs( generate_specs( seed ) );
+
+   std::cout << "\n Million vehicles per second and core (and total distance)\n"
+             << "\n Threads"
+#if BENCHMARK_STRATEGY_SOLUTION
+             << std::setw(31) << "std::unique_ptr<Engine>"
+#endif
+#if BENCHMARK_SOA_SOLUTION
+             << std::setw(31) << "SoA fleet"
+#endif
+             << "\n";
+
+   std::vector<size_t> threads{ 0UL };
+   unsigned int const max_threads( std::max( std::thread::hardware_concurrency(), 1U ) );
+   for( size_t t=1UL; t<max_threads; t*=2UL ) {
+      threads.push_back( t );
+   }
+   threads.push_back( max_threads );
+
+   for( size_t t : threads )
+   {
+      if( t == 0UL ) std::cout << "    none";
+      else std::cout << " " << std::setw(7) << t;
+
+#if BENCHMARK_STRATEGY_SOLUTION
+      benchmark<strategy_solution::Fleet>( specs, t );
+#endif
+
+#if BENCHMARK_SOA_SOLUTION
+      benchmark<soa_solution::Fleet>( specs, t );
+#endif
+
+      std::cout << "\n";
+   }
+
+   std::cout << std::endl;
+
+   return EXIT_SUCCESS;
+}
@@ -0,0 +1,255 @@
+/**************************************************************************************************
+*
+* \file HotColdSplitting.cpp
+* \brief C++ Training - Data Members Performance Benchmark with Generated Hot/Cold Layouts
+*
+* Copyright (C) 2015-2023 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+* Task: Copy-and-paste the following code into 'quick-bench.com'. Benchmark the time to determine
+*       the oldest person contained in a table of Persons. In contrast to 'BridgedMembers.cpp',
+*       the layouts of all Persons are generated from a declaration of their hot and cold data
+*       members.
+*
+**************************************************************************************************/
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <ranges>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+
+//---- Benchmark configuration --------------------------------------------------------------------
+
+constexpr size_t size( 10000 );  // Size of the generated container
+constexpr size_t iterations( 1000 );  // Number of benchmark iterations
+
+#define BENCHMARK_PERSON1 1
+#define BENCHMARK_PERSON2 1
+#define BENCHMARK_PERSON3 1
+#define BENCHMARK_PERSON4 1
+#define BENCHMARK_PERSON5 1
+#define BENCHMARK_PERSON6 1
+
+
+//---- Random Number Setup ------------------------------------------------------------------------
+
+std::random_device rd{};
+
+std::uniform_int_distribution<int> dist( 1957, 2004 );
+
+int get_random_year_of_birth()
+{
+   return dist( rd );
+}
+
+
+//---- Hot/cold splitting framework ---------------------------------------------------------------
+
+// A field is a type providing the type of a data member ('type') and its initial value ('init()')
+template< typename... Fields > struct Hot {};
+template< typename... Fields > struct Cold {};
+
+template< typename Field >
+struct Member
+{
+   typename Field::type value{ Field::init() };
+};
+
+// A group of data members, laid out in declaration order
+template< typename... Fields >
+struct Members : public Member<Fields>...
+{
+   template< typename Field >
+   static constexpr bool contains = ( std::is_same_v<Field,Fields> || ... );
+};
+
+template< typename Field, typename... Fields >
+typename Field::type& member( Members<Fields...>& m )
+{
+   return static_cast<Member<Field>&>( m ).value;
+}
+
+template< typename Field, typename... Fields >
+typename Field::type const& member( Members<Fields...> const& m )
+{
+   return static_cast<Member<Field> const&>( m ).value;
+}
+
+
+// The available layouts
+struct Inline {};     // All data members inline (see Person1 and Person5)
+struct Pimpl {};      // All data members behind a pointer (see Person2)
+struct ColdPimpl {};  // Hot data members inline, cold data members behind a pointer (see Person3 and Person4)
+struct ColdTable {};  // Hot and cold data members in two separate, parallel tables (see Person6)
+
+
+template< typename Layout, typename HotFields, typename ColdFields >
+struct Record;
+
+template< typename... Hs, typename... Cs >
+struct Record< Inline, Hot<Hs...>, Cold<Cs...> >
+{
+   template< typename Field > decltype(auto) get() { return member<Field>( members ); }
+   template< typename Field > decltype(auto) get() const { return member<Field>( members ); }
+
+   Members<Hs...,Cs...> members;
+};
+
+template< typename... Hs, typename... Cs >
+struct Record< Pimpl, Hot<Hs...>, Cold<Cs...> >
+{
+   template< typename Field > decltype(auto) get() { return member<Field>( *pimpl ); }
+   template< typename Field > decltype(auto) get() const { return member<Field>( *pimpl ); }
+
+   std::unique_ptr< Members<Hs...,Cs...> > pimpl{ std::make_unique< Members<Hs...,Cs...> >() };
+};
+
+template< typename... Hs, typename... Cs >
+struct Record< ColdPimpl, Hot<Hs...>, Cold<Cs...> >
+{
+   template< typename Field >
+   decltype(auto) get()
+   {
+      if constexpr( Members<Hs...>::template contains<Field> ) return member<Field>( hot );
+      else return member<Field>( *cold );
+   }
+
+   template< typename Field >
+   decltype(auto) get() const
+   {
+      if constexpr( Members<Hs...>::template contains<Field> ) return member<Field>( hot );
+      else return member<Field>( *cold );
+   }
+
+   Members<Hs...> hot;
+   std::unique_ptr< Members<Cs...> > cold{ std::make_unique< Members<Cs...> >() };
+};
+
+
+// A table of records. All layouts that can be represented by a single record type are stored
+// in a 'std::vector' of records, the 'ColdTable' layout stores two parallel 'std::vector's.
+template< typename Layout, typename HotFields, typename ColdFields >
+class Table
+{
+ public:
+   using RecordType = Record<Layout,HotFields,ColdFields>;
+
+   explicit Table( size_t n ) : records_( n ) {}
+
+   size_t size() const { return records_.size(); }
+
+   template< typename Field > decltype(auto) get( size_t i ) { return records_[i].template get<Field>(); }
+   template< typename Field > decltype(auto) get( size_t i ) const { return records_[i].template get<Field>(); }
+
+   // A view on a single data member of all records
+   template< typename Field >
+   auto column() const
+   {
+      return records_ | std::views::transform( []( RecordType const& r ) -> decltype(auto) {
+         return r.template get<Field>();
+      } );
+   }
+
+ private:
+   std::vector<RecordType> records_;
+};
+
+template< typename... Hs, typename... Cs >
+class Table< ColdTable, Hot<Hs...>, Cold<Cs...> >
+{
+ public:
+   explicit Table( size_t n ) : hot_( n ), cold_( n ) {}
+
+   size_t size() const { return hot_.size(); }
+
+   template< typename Field >
+   decltype(auto) get( size_t i )
+   {
+      if constexpr( Members<Hs...>::template contains<Field> ) return member<Field>( hot_[i] );
+      else return member<Field>( cold_[i] );
+   }
+
+   template< typename Field >
+   decltype(auto) get( size_t i ) const
+   {
+      if constexpr( Members<Hs...>::template contains<Field> ) return member<Field>( hot_[i] );
+      else return member<Field>( cold_[i] );
+   }
+
+   // A view on a single data member of all records
+   template< typename Field >
+   auto column() const
+   {
+      auto const projection = []( auto const& m ) -> decltype(auto) { return member<Field>( m ); };
+
+      if constexpr( Members<Hs...>::template contains<Field> ) return hot_ | std::views::transform( projection );
+      else return cold_ | std::views::transform( projection );
+   }
+
+ private:
+   std::vector< Members<Hs...> > hot_;
+   std::vector< Members<Cs...> > cold_;
+};
+
+
+//---- Person fields ------------------------------------------------------------------------------
+
+struct Forename    { using type = std::string; static type init() { return "Homer"; } };
+struct Surname     { using type = std::string; static type init() { return "Simpson"; } };
+struct Address     { using type = std::string; static type init() { return "712 Red Bark Lane"; } };
+struct Zip         { using type = std::string; static type init() { return "89011"; } };
+struct City        { using type = std::string; static type init() { return "Henderson"; } };
+struct State       { using type = std::string; static type init() { return "Nevada"; } };
+struct YearOfBirth { using type = int;         static type init() { return get_random_year_of_birth(); } };
+
+
+//---- Person layouts (equivalent to Person1 to Person6 in 'BridgedMembers.cpp') ------------------
+
+using Person1 = Table< Inline,    Hot<YearOfBirth>, Cold<Forename,Surname,Address,Zip,City,State> >;
+using Person2 = Table< Pimpl,     Hot<YearOfBirth>, Cold<Forename,Surname,Address,Zip,City,State> >;
+using Person3 = Table< ColdPimpl, Hot<Forename,Surname,YearOfBirth>, Cold<Address,Zip,City,State> >;
+using Person4 = Table< ColdPimpl, Hot<YearOfBirth>, Cold<Forename,Surname,Address,Zip,City,State> >;
+using Person5 = Table< Inline,    Hot<Forename,Surname,YearOfBirth>, Cold<Address,Zip,City,State> >;
+using Person6 = Table< ColdTable, Hot<YearOfBirth>, Cold<Forename,Surname,Address,Zip,City,State> >;
+
+
+//---- Benchmark ----------------------------------------------------------------------------------
+
+template< typename Persons >
+static void determineOldestPerson(benchmark::State& state)
+{
+   Persons const persons( size );
+
+   for( auto _ : state )
+   {
+      auto const years( persons.template column<YearOfBirth>() );
+      benchmark::DoNotOptimize(
+         std::distance( years.begin(), std::ranges::min_element( years ) )
+      );
+   }
+}
+#if BENCHMARK_PERSON1
+BENCHMARK_TEMPLATE(determineOldestPerson,Person1)->Iterations(iterations);
+#endif
+#if BENCHMARK_PERSON2
+BENCHMARK_TEMPLATE(determineOldestPerson,Person2)->Iterations(iterations);
+#endif
+#if BENCHMARK_PERSON3
+BENCHMARK_TEMPLATE(determineOldestPerson,Person3)->Iterations(iterations);
+#endif
+#if BENCHMARK_PERSON4
+BENCHMARK_TEMPLATE(determineOldestPerson,Person4)->Iterations(iterations);
+#endif
+#if BENCHMARK_PERSON5
+BENCHMARK_TEMPLATE(determineOldestPerson,Person5)->Iterations(iterations);
+#endif
+#if BENCHMARK_PERSON6
+BENCHMARK_TEMPLATE(determineOldestPerson,Person6)->Iterations(iterations);
+#endif
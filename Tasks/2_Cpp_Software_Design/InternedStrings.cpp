@@ -0,0 +1,341 @@
+/**************************************************************************************************
+*
+* \file InternedStrings.cpp
+* \brief C++ Training - Data Members Performance Benchmark for Interned String Members
+*
+* Copyright (C) 2015-2023 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+* Task: Copy-and-paste the following code into 'quick-bench.com'. Benchmark the time to construct
+*       a table of Persons and the time to compare their string members, both for 'std::string'
+*       members (see Person1 in 'BridgedMembers.cpp') and for interned string members. Compare
+*       the memory footprint per person reported by the 'bytes/person' counter.
+*
+**************************************************************************************************/
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+
+//---- Benchmark configuration --------------------------------------------------------------------
+
+constexpr size_t size( 10000 );  // Size of the generated container
+constexpr size_t iterations( 1000 );  // Number of benchmark iterations
+constexpr double repetition( 0.8 );  // Fraction of repeated strings in the generated records
+
+#define BENCHMARK_PERSON1 1
+#define BENCHMARK_INTERNED_PERSON 1
+
+
+//---- Allocation counting ------------------------------------------------------------------------
+
+// Counts the number of bytes allocated via the global 'operator new'. The functions are not
+// inlined to keep the compiler from pairing the allocation and deallocation functions.
+size_t allocated_bytes{};
+
+[[gnu::noinline]] void* operator new( size_t bytes )
+{
+   allocated_bytes += bytes;
+   if( void* const ptr = std::malloc( bytes ) ) return ptr;
+   throw std::bad_alloc{};
+}
+
+[[gnu::noinline]] void operator delete( void* ptr ) noexcept { std::free( ptr ); }
+[[gnu::noinline]] void operator delete( void* ptr, size_t ) noexcept { std::free( ptr ); }
+
+
+//---- Random Number Setup ------------------------------------------------------------------------
+
+std::random_device rd{};
+
+std::mt19937 rng{ rd() };
+std::uniform_int_distribution<int> dist( 1957, 2004 );
+
+int get_random_year_of_birth()
+{
+   return dist( rng );
+}
+
+
+//---- Interned strings ---------------------------------------------------------------------------
+
+// Stores every distinct string exactly once in a chunked buffer and hands out 4-byte handles.
+// The handle 0 is reserved for the empty string. Note that the pool is not thread-safe.
+class StringPool
+{
+ public:
+   using Handle = std::uint32_t;
+
+   StringPool() { views_.emplace_back(); }
+
+   Handle intern( std::string_view s )
+   {
+      if( s.empty() ) return Handle{};
+
+      if( auto const pos = index_.find( s ); pos != index_.end() ) {
+         return pos->second;
+      }
+
+      char* const data( allocate( s.size() ) );
+      std::memcpy( data, s.data(), s.size() );
+
+      Handle const handle( static_cast<Handle>( views_.size() ) );
+      views_.emplace_back( data, s.size() );
+      index_.emplace( views_.back(), handle );
+      return handle;
+   }
+
+   std::string_view view( Handle handle ) const { return views_[handle]; }
+
+   size_t size() const { return views_.size() - 1UL; }
+
+   // The memory footprint of the pool: the character chunks, the handle table, and the hash
+   // index. The size of an index node (key, value, next pointer, and cached hash) is an estimate
+   // of the typical 'std::unordered_map' implementation.
+   size_t bytes() const
+   {
+      using Node = std::pair<std::string_view const,Handle>;
+
+      return chunk_bytes_
+           + views_.capacity() * sizeof(std::string_view)
+           + index_.bucket_count() * sizeof(void*)
+           + index_.size() * ( sizeof(Node) + sizeof(void*) + sizeof(size_t) );
+   }
+
+ private:
+   static constexpr size_t chunk_size = 64UL*1024UL;
+
+   char* allocate( size_t n )
+   {
+      if( chunks_.empty() || used_ + n > chunk_size ) {
+         chunks_.emplace_back( std::make_unique<char[]>( std::max( n, chunk_size ) ) );
+         chunk_bytes_ += std::max( n, chunk_size );
+         used_ = 0UL;
+      }
+      char* const ptr( chunks_.back().get() + used_ );
+      used_ += n;
+      return ptr;
+   }
+
+   std::vector< std::unique_ptr<char[]> > chunks_;
+   size_t chunk_bytes_{};
+   size_t used_{};
+   std::vector<std::string_view> views_;
+   std::unordered_map<std::string_view,Handle> index_;
+};
+
+
+// A 4-byte, trivially copyable string value. Two interned strings are equal if and only if
+// their handles are equal.
+class InternedString
+{
+ public:
+   InternedString() = default;
+   InternedString( char const* s ) : handle_( pool().intern( s ) ) {}
+   InternedString( std::string_view s ) : handle_( pool().intern( s ) ) {}
+   InternedString( std::string const& s ) : handle_( pool().intern( s ) ) {}
+
+   std::string_view view() const { return pool().view( handle_ ); }
+   size_t size() const { return view().size(); }
+   bool empty() const { return handle_ == 0U; }
+
+   friend bool operator==( InternedString lhs, InternedString rhs ) { return lhs.handle_ == rhs.handle_; }
+
+   static StringPool& pool()
+   {
+      static StringPool pool{};
+      return pool;
+   }
+
+ private:
+   StringPool::Handle handle_{};
+};
+
+static_assert( sizeof(InternedString) == 4UL );
+
+
+//---- Person implementations ---------------------------------------------------------------------
+
+struct Person1
+{
+   std::string forename{ "Homer" };
+   std::string surname{ "Simpson" };
+   std::string address{ "712 Red Bark Lane" };
+   std::string zip{ "89011" };
+   std::string city{ "Henderson" };
+   std::string state{ "Nevada" };
+   int year_of_birth{ get_random_year_of_birth() };
+};
+
+// Interns the default strings on every construction
+struct InternedPerson
+{
+   InternedString forename{ "Homer" };
+   InternedString surname{ "Simpson" };
+   InternedString address{ "712 Red Bark Lane" };
+   InternedString zip{ "89011" };
+   InternedString city{ "Henderson" };
+   InternedString state{ "Nevada" };
+   int year_of_birth{ get_random_year_of_birth() };
+};
+
+// Interns the default strings once and copies the handles on every construction
+namespace defaults {
+   InternedString const forename{ "Homer" };
+   InternedString const surname{ "Simpson" };
+   InternedString const address{ "712 Red Bark Lane" };
+   InternedString const zip{ "89011" };
+   InternedString const city{ "Henderson" };
+   InternedString const state{ "Nevada" };
+}
+
+struct CachedInternedPerson
+{
+   InternedString forename{ defaults::forename };
+   InternedString surname{ defaults::surname };
+   InternedString address{ defaults::address };
+   InternedString zip{ defaults::zip };
+   InternedString city{ defaults::city };
+   InternedString state{ defaults::state };
+   int year_of_birth{ get_random_year_of_birth() };
+};
+
+
+//---- Record generation --------------------------------------------------------------------------
+
+// A record as it arrives from outside, e.g. from a file or a database. A fraction 'repetition'
+// of all strings is drawn from a small set of common values, all other strings are unique.
+using Record = std::array<std::string,6>;
+
+std::vector<Record> generate_records( size_t n )
+{
+   static constexpr std::array<std::array<char const*,4>,6> common{ {
+      { "Homer", "Marge", "Bart", "Lisa" },
+      { "Simpson", "Flanders", "Szyslak", "Gumble" },
+      { "712 Red Bark Lane", "744 Evergreen Terrace", "57 Mount Street", "1313 Mockingbird Lane" },
+      { "89011", "89012", "89014", "89015" },
+      { "Henderson", "Springfield", "Shelbyville", "Capital City" },
+      { "Nevada", "Oregon", "Kentucky", "Ohio" }
+   } };
+
+   std::bernoulli_distribution repeated( repetition );
+   std::uniform_int_distribution<size_t> choice( 0UL, 3UL );
+
+   std::vector<Record> records( n );
+   size_t unique{};
+   for( auto& record : records ) {
+      for( size_t field=0UL; field<record.size(); ++field ) {
+         record[field] = repeated( rng ) ? std::string{ common[field][choice( rng )] }
+                                         : std::string{ common[field][0] } + " #" + std::to_string( ++unique );
+      }
+   }
+   return records;
+}
+
+
+//---- Construction benchmarks --------------------------------------------------------------------
+
+template< typename Person >
+static void constructPerson(benchmark::State& state)
+{
+   size_t bytes{};
+
+   for( auto _ : state )
+   {
+      size_t const before( allocated_bytes );
+      std::vector<Person> persons( size );
+      bytes = allocated_bytes - before;
+      benchmark::DoNotOptimize( persons.data() );
+   }
+
+   state.counters["bytes/person"] = static_cast<double>( bytes ) / size;
+}
+#if BENCHMARK_PERSON1
+BENCHMARK_TEMPLATE(constructPerson,Person1)->Iterations(iterations);
+#endif
+#if BENCHMARK_INTERNED_PERSON
+BENCHMARK_TEMPLATE(constructPerson,InternedPerson)->Iterations(iterations);
+BENCHMARK_TEMPLATE(constructPerson,CachedInternedPerson)->Iterations(iterations);
+#endif
+
+
+template< typename Person >
+Person make_person( Record const& r )
+{
+   return Person{ r[0], r[1], r[2], r[3], r[4], r[5], get_random_year_of_birth() };
+}
+
+template< typename Person >
+static void constructPersonFromRecords(benchmark::State& state)
+{
+   std::vector<Record> const records( generate_records( size ) );
+   size_t bytes{};
+
+   for( auto _ : state )
+   {
+      size_t const before( allocated_bytes );
+      std::vector<Person> persons;
+      persons.reserve( records.size() );
+      for( auto const& record : records ) {
+         persons.push_back( make_person<Person>( record ) );
+      }
+      bytes = allocated_bytes - before;
+      benchmark::DoNotOptimize( persons.data() );
+   }
+
+   // For interned strings, the characters of the unique strings are stored in the pool during the
+   // first iteration. Since the pool is shared by all persons, its footprint is not part of
+   // 'bytes/person', but reported separately.
+   state.counters["bytes/person"] = static_cast<double>( bytes ) / size;
+   state.counters["pooled strings"] = static_cast<double>( InternedString::pool().size() );
+   state.counters["pool bytes"] = static_cast<double>( InternedString::pool().bytes() );
+}
+#if BENCHMARK_PERSON1
+BENCHMARK_TEMPLATE(constructPersonFromRecords,Person1)->Iterations(iterations);
+#endif
+#if BENCHMARK_INTERNED_PERSON
+BENCHMARK_TEMPLATE(constructPersonFromRecords,InternedPerson)->Iterations(iterations);
+#endif
+
+
+//---- Comparison benchmarks ----------------------------------------------------------------------
+
+template< typename Person >
+static void countNeighbours(benchmark::State& state)
+{
+   std::vector<Record> const records( generate_records( size ) );
+   std::vector<Person> persons;
+   persons.reserve( records.size() );
+   for( auto const& record : records ) {
+      persons.push_back( make_person<Person>( record ) );
+   }
+
+   for( auto _ : state )
+   {
+      auto const& first( persons.front() );
+      benchmark::DoNotOptimize(
+         std::count_if( begin(persons), end(persons), [&]( Person const& p ){
+            return p.address == first.address && p.city == first.city && p.state == first.state;
+         } )
+      );
+   }
+}
+#if BENCHMARK_PERSON1
+BENCHMARK_TEMPLATE(countNeighbours,Person1)->Iterations(iterations);
+#endif
+#if BENCHMARK_INTERNED_PERSON
+BENCHMARK_TEMPLATE(countNeighbours,InternedPerson)->Iterations(iterations);
+#endif
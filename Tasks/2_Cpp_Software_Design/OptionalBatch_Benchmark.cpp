@@ -0,0 +1,317 @@
+/**************************************************************************************************
+*
+* \file OptionalBatch_Benchmark.cpp
+* \brief C++ Training - Benchmark for a Scalar and a Batch Evaluation of the Adapter_3 Pipeline
+*
+* Copyright (C) 2015-2023 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#define BENCHMARK_SCALAR_SOLUTION 1
+#define BENCHMARK_BATCH_SOLUTION 1
+
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <span>
+#include <sstream>
+#include <vector>
+
+#if ( defined(__GNUC__) || defined(__clang__) ) && ( defined(__x86_64__) || defined(__i386__) )
+#  define KERNELS_AVX2 1
+#  include <immintrin.h>
+#else
+#  define KERNELS_AVX2 0
+#endif
+
+
+//---- Benchmark configuration --------------------------------------------------------------------
+
+constexpr size_t N( 1000000UL );  // Number of inputs
+constexpr size_t iterations( 100UL );  // Number of benchmark iterations
+
+
+#if BENCHMARK_SCALAR_SOLUTION
+namespace scalar_solution {
+
+   // The solution of 'Adapter_3.cpp': Every input is passed one by one through the three
+   // functions, connected by an adapter for 'std::optional'
+
+   std::optional<double> doSomething( double d )
+   {
+      if( d >= 0.0 ) {
+         return std::sqrt( d );
+      }
+      else {
+         return std::nullopt;
+      }
+   }
+
+   std::optional<double> doSomethingElse( double d )
+   {
+      if( d > 0.0 && d < 10.0 ) {
+         return d * 2.0;
+      }
+      else {
+         return std::nullopt;
+      }
+   }
+
+   std::optional<double> doAThirdThing( double d )
+   {
+      if( d > 2.0 ) {
+         return d / 4.0;
+      }
+      else {
+         return std::nullopt;
+      }
+   }
+
+   using FP = std::optional<double>(*)(double);
+
+   std::optional<double> map( FP fn, std::optional<double> d )
+   {
+      if( d.has_value() ) {
+         return fn(d.value());
+      }
+      else
+         return std::nullopt;
+   }
+
+   std::optional<double> operator|( std::optional<double> opt, FP fn )
+   {
+      return map( fn, opt );
+   }
+
+   std::optional<double> doSomeWork( double d )
+   {
+      return std::make_optional(d)
+           | doSomething
+           | doSomethingElse
+           | doAThirdThing;
+   }
+
+} // namespace scalar_solution
+#endif
+
+
+#if BENCHMARK_BATCH_SOLUTION
+namespace batch_solution {
+
+   // The batch form of 'doSomeWork()': Instead of an optional per element, the validity of the
+   // elements is tracked in a bitmask, in which bit 'i%64' of word 'i/64' represents element 'i'.
+   // All three functions are evaluated for all elements, the bitmask records which elements
+   // fulfilled all preconditions. The values of invalid elements are set to zero.
+
+   constexpr size_t words( size_t n ) { return ( n + 63UL ) / 64UL; }
+
+   // Portable, branch-free form of the three functions for a single element
+   inline double doSomeWork( double d, bool& valid )
+   {
+      bool v( d >= 0.0 );
+      d = std::sqrt( v ? d : 0.0 );  // doSomething()
+      v &= ( d > 0.0 ) & ( d < 10.0 );
+      d = d * 2.0;                   // doSomethingElse()
+      v &= ( d > 2.0 );
+      d = d / 4.0;                   // doAThirdThing()
+      valid = v;
+      return v ? d : 0.0;
+   }
+
+   void doSomeWork_scalar( std::span<double const> input, std::span<double> output, std::span<std::uint64_t> valid )
+   {
+      size_t const n( input.size() );
+
+      for( size_t w=0UL; w<words(n); ++w )
+      {
+         std::uint64_t mask( 0UL );
+         size_t const end( std::min( n, (w+1UL)*64UL ) );
+
+         for( size_t i=w*64UL; i<end; ++i ) {
+            bool v{};
+            output[i] = doSomeWork( input[i], v );
+            mask |= static_cast<std::uint64_t>( v ) << ( i % 64UL );
+         }
+
+         valid[w] = mask;
+      }
+   }
+
+#if KERNELS_AVX2
+   __attribute__((target("avx2")))
+   void doSomeWork_avx2( std::span<double const> input, std::span<double> output, std::span<std::uint64_t> valid )
+   {
+      size_t const n( input.size() );
+      double const* const in( input.data() );
+      double* const out( output.data() );
+
+      __m256d const zero( _mm256_setzero_pd() );
+      __m256d const two ( _mm256_set1_pd( 2.0 ) );
+      __m256d const four( _mm256_set1_pd( 4.0 ) );
+      __m256d const ten ( _mm256_set1_pd( 10.0 ) );
+
+      // Every iteration of the inner loop handles four elements, i.e. four bits of the mask
+      size_t const full( n / 64UL );
+      for( size_t w=0UL; w<full; ++w )
+      {
+         std::uint64_t mask( 0UL );
+
+         for( size_t j=0UL; j<64UL; j+=4UL )
+         {
+            size_t const i( w*64UL + j );
+
+            __m256d d( _mm256_loadu_pd( in+i ) );
+            __m256d v( _mm256_cmp_pd( d, zero, _CMP_GE_OQ ) );
+
+            d = _mm256_sqrt_pd( _mm256_and_pd( d, v ) );  // doSomething()
+            v = _mm256_and_pd( v, _mm256_and_pd( _mm256_cmp_pd( d, zero, _CMP_GT_OQ ), _mm256_cmp_pd( d, ten, _CMP_LT_OQ ) ) );
+            d = _mm256_mul_pd( d, two );                  // doSomethingElse()
+            v = _mm256_and_pd( v, _mm256_cmp_pd( d, two, _CMP_GT_OQ ) );
+            d = _mm256_div_pd( d, four );                 // doAThirdThing()
+
+            _mm256_storeu_pd( out+i, _mm256_and_pd( d, v ) );
+            mask |= static_cast<std::uint64_t>( _mm256_movemask_pd( v ) ) << j;
+         }
+
+         valid[w] = mask;
+      }
+
+      if( full*64UL < n ) {
+         doSomeWork_scalar( input.subspan( full*64UL ), output.subspan( full*64UL ), valid.subspan( full ) );
+      }
+   }
+
+   bool has_avx2()
+   {
+      static bool const avx2( __builtin_cpu_supports( "avx2" ) );
+      return avx2;
+   }
+#endif
+
+   // Evaluates the pipeline for all elements of 'input'. 'output' must provide (at least) the
+   // same number of elements as 'input', 'valid' at least 'words(input.size())' words.
+   void doSomeWork( std::span<double const> input, std::span<double> output, std::span<std::uint64_t> valid )
+   {
+#if KERNELS_AVX2
+      if( has_avx2() ) return doSomeWork_avx2( input, output, valid );
+#endif
+      doSomeWork_scalar( input, output, valid );
+   }
+
+} // namespace batch_solution
+#endif
+
+
+//---- Benchmark ----------------------------------------------------------------------------------
+
+template< typename Function >
+double measure( Function function )
+{
+   std::chrono::time_point<std::chrono::high_resolution_clock> start, end;
+   start = std::chrono::high_resolution_clock::now();
+
+   for( size_t rep=0UL; rep<iterations; ++rep ) {
+      function();
+   }
+
+   end = std::chrono::high_resolution_clock::now();
+   std::chrono::duration<double> const elapsedTime( end - start );
+   return elapsedTime.count();
+}
+
+
+void report( char const* label, double seconds, size_t valid, double sum )
+{
+   // The formatting flags are set on a local stream to leave 'std::cout' unchanged
+   std::ostringstream os;
+   os << " " << std::left << std::setw(32) << label << ": " << std::right
+      << std::setw(7) << std::setprecision(4) << seconds/(N*iterations)*1E9 << " ns/element"
+      << "  (" << valid << " valid, sum = " << std::setprecision(12) << sum << ")\n";
+   std::cout << os.str();
+}
+
+
+int main()
+{
+   std::random_device rd{};
+   unsigned int const seed( rd() );
+
+   // About half of the inputs pass all three functions, in random order
+   std::mt19937 rng{ seed };
+   std::uniform_real_distribution<double> dist( -50.0, 150.0 );
+
+   std::vector<double> input( N );
+   for( double& d : input ) {
+      d = dist( rng );
+   }
+
+   std::cout << "\n " << N << " inputs\n";
+
+#if BENCHMARK_SCALAR_SOLUTION
+   {
+      std::vector<std::optional<double>> output( N );
+
+      double const seconds = measure( [&](){
+         for( size_t i=0UL; i<N; ++i ) {
+            output[i] = scalar_solution::doSomeWork( input[i] );
+         }
+      } );
+
+      size_t valid( 0UL );
+      double sum( 0.0 );
+      for( auto const& result : output ) {
+         if( result.has_value() ) {
+            ++valid;
+            sum += result.value();
+         }
+      }
+
+      report( "Scalar (std::optional)", seconds, valid, sum );
+   }
+#endif
+
+#if BENCHMARK_BATCH_SOLUTION
+   {
+      std::vector<double> output( N );
+      std::vector<std::uint64_t> mask( batch_solution::words( N ) );
+
+      auto const evaluate = [&]( char const* label, auto kernel )
+      {
+         double const seconds = measure( [&](){ kernel( input, output, mask ); } );
+
+         size_t valid( 0UL );
+         double sum( 0.0 );
+         for( size_t i=0UL; i<N; ++i ) {
+            if( mask[i/64UL] & ( std::uint64_t{1} << ( i % 64UL ) ) ) {
+               ++valid;
+               sum += output[i];
+            }
+         }
+
+         report( label, seconds, valid, sum );
+      };
+
+      evaluate( "Batch (bitmask)", batch_solution::doSomeWork_scalar );
+#if KERNELS_AVX2
+      if( batch_solution::has_avx2() ) {
+         evaluate( "Batch (bitmask, AVX2)", batch_solution::doSomeWork_avx2 );
+      }
+#endif
+   }
+#endif
+
+   std::cout << std::endl;
+
+   return EXIT_SUCCESS;
+}
@@ -0,0 +1,416 @@
+/**************************************************************************************************
+*
+* \file OptionalPipeline_Benchmark.cpp
+* \brief C++ Training - Benchmark for a Compile-Time Pipeline of Optional-Returning Stages
+*
+* Copyright (C) 2015-2023 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#define BENCHMARK_MAP_SOLUTION 1
+#define BENCHMARK_NESTED_IF_SOLUTION 1
+#define BENCHMARK_PIPELINE_SOLUTION 1
+
+
+//---- <Pipeline.h> -------------------------------------------------------------------------------
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <sstream>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+template< typename T >
+struct is_optional : public std::false_type {};
+
+template< typename T >
+struct is_optional< std::optional<T> > : public std::true_type {};
+
+// A stage is any callable that maps a 'T' to a 'std::optional<U>'
+template< typename Stage, typename T >
+concept OptionalStage =
+   std::invocable<Stage const&,T const&> &&
+   is_optional< std::remove_cvref_t< std::invoke_result_t<Stage const&,T const&> > >::value;
+
+
+// Composes any number of optional-returning stages into a single function. The pipeline is lazy:
+// Composing only creates a new type, all stages are evaluated only when the pipeline is called.
+// The evaluation runs the stages one after another and, as soon as a stage returns an empty
+// optional, jumps directly to the (empty) result. In contrast to a chain of 'map()' calls, no
+// optional is passed from stage to stage and none of the remaining stages is visited.
+template< typename... Stages >
+class Pipeline
+{
+ public:
+   constexpr explicit Pipeline( Stages... stages )
+      : stages_( std::move(stages)... )
+   {}
+
+   // Scalar form: Evaluates all stages for a single value
+   template< typename T >
+      requires ( sizeof...(Stages) > 0UL ) && OptionalStage<std::tuple_element_t<0UL,std::tuple<Stages...>>,T>
+   constexpr auto operator()( T const& value ) const
+   {
+      return evaluate<0UL>( value );
+   }
+
+   // Batch form: Evaluates all stages for all elements of 'input'. Bit 'i%64' of word 'i/64' in
+   // 'valid' states whether element 'i' passed all stages, invalid elements of 'output' are
+   // value initialized. 'output' must provide (at least) as many elements as 'input', 'valid'
+   // at least '(input.size()+63)/64' words.
+   template< typename T, typename R >
+   constexpr void operator()( std::span<T const> input, std::span<R> output, std::span<std::uint64_t> valid ) const
+   {
+      size_t const n( input.size() );
+
+      for( size_t w=0UL; w*64UL<n; ++w )
+      {
+         std::uint64_t mask( 0UL );
+         size_t const end( n < (w+1UL)*64UL ? n : (w+1UL)*64UL );
+
+         for( size_t i=w*64UL; i<end; ++i ) {
+            auto const result( evaluate<0UL>( input[i] ) );
+            output[i] = result.has_value() ? *result : R{};
+            mask |= static_cast<std::uint64_t>( result.has_value() ) << ( i % 64UL );
+         }
+
+         valid[w] = mask;
+      }
+   }
+
+   // Appends a further stage to the pipeline
+   template< typename Stage >
+   friend constexpr Pipeline<Stages...,Stage> operator|( Pipeline const& pipeline, Stage stage )
+   {
+      return std::apply( [&stage]( Stages const&... stages ){
+         return Pipeline<Stages...,Stage>( stages..., std::move(stage) );
+      }, pipeline.stages_ );
+   }
+
+ private:
+   template< size_t I, typename T >
+   constexpr auto evaluate( T const& value ) const
+   {
+      auto result( std::get<I>( stages_ )( value ) );
+
+      if constexpr( I+1UL == sizeof...(Stages) ) {
+         return result;
+      }
+      else {
+         using Result = decltype( evaluate<I+1UL>( *result ) );
+         if( !result.has_value() ) return Result{};
+         return evaluate<I+1UL>( *result );
+      }
+   }
+
+   std::tuple<Stages...> stages_;
+};
+
+template< typename... Stages >
+constexpr Pipeline<Stages...> pipeline( Stages... stages )
+{
+   return Pipeline<Stages...>( std::move(stages)... );
+}
+
+
+//---- <Stages.h> ---------------------------------------------------------------------------------
+
+#include <cmath>
+
+// The three functions of 'Adapter_3.cpp'
+
+std::optional<double> doSomething( double d )
+{
+   if( d >= 0.0 ) {
+      return std::sqrt( d );
+   }
+   else {
+      return std::nullopt;
+   }
+}
+
+std::optional<double> doSomethingElse( double d )
+{
+   if( d > 0.0 && d < 10.0 ) {
+      return d * 2.0;
+   }
+   else {
+      return std::nullopt;
+   }
+}
+
+std::optional<double> doAThirdThing( double d )
+{
+   if( d > 2.0 ) {
+      return d / 4.0;
+   }
+   else {
+      return std::nullopt;
+   }
+}
+
+// Further validation and transformation stages
+
+template< double Lower, double Upper >
+std::optional<double> within( double d )
+{
+   if( Lower <= d && d <= Upper ) {
+      return d;
+   }
+   else {
+      return std::nullopt;
+   }
+}
+
+template< double Factor >
+std::optional<double> scale( double d )
+{
+   return d * Factor;
+}
+
+std::optional<double> reciprocal( double d )
+{
+   if( d != 0.0 ) {
+      return 1.0 / d;
+   }
+   else {
+      return std::nullopt;
+   }
+}
+
+std::optional<double> logarithm( double d )
+{
+   if( d > 0.0 ) {
+      return std::log( d );
+   }
+   else {
+      return std::nullopt;
+   }
+}
+
+
+#if BENCHMARK_MAP_SOLUTION
+namespace map_solution {
+
+   // The solution of 'Adapter_3.cpp': Every stage is connected by means of 'map()'
+
+   using FP = std::optional<double>(*)(double);
+
+   std::optional<double> map( FP fn, std::optional<double> d )
+   {
+      if( d.has_value() ) {
+         return fn(d.value());
+      }
+      else
+         return std::nullopt;
+   }
+
+   std::optional<double> operator|( std::optional<double> opt, FP fn )
+   {
+      return map( fn, opt );
+   }
+
+   std::optional<double> validate( double d )
+   {
+      return std::make_optional(d)
+           | doSomething
+           | doSomethingElse
+           | doAThirdThing
+           | within<0.5,4.5>
+           | scale<4.0>
+           | reciprocal
+           | within<0.05,1.0>
+           | logarithm
+           | scale<-1.0>
+           | within<0.0,3.0>
+           | doSomething
+           | doSomethingElse
+           | scale<2.0>
+           | within<0.1,20.0>
+           | reciprocal
+           | scale<100.0>;
+   }
+
+} // namespace map_solution
+#endif
+
+
+#if BENCHMARK_NESTED_IF_SOLUTION
+namespace nested_if_solution {
+
+   // The "Pyramid of Doom", written by hand (and flattened by early returns)
+   std::optional<double> validate( double d )
+   {
+      auto r1 = doSomething( d );                    if( !r1 ) return std::nullopt;
+      auto r2 = doSomethingElse( *r1 );              if( !r2 ) return std::nullopt;
+      auto r3 = doAThirdThing( *r2 );                if( !r3 ) return std::nullopt;
+      auto r4 = within<0.5,4.5>( *r3 );              if( !r4 ) return std::nullopt;
+      auto r5 = scale<4.0>( *r4 );                   if( !r5 ) return std::nullopt;
+      auto r6 = reciprocal( *r5 );                   if( !r6 ) return std::nullopt;
+      auto r7 = within<0.05,1.0>( *r6 );             if( !r7 ) return std::nullopt;
+      auto r8 = logarithm( *r7 );                    if( !r8 ) return std::nullopt;
+      auto r9 = scale<-1.0>( *r8 );                  if( !r9 ) return std::nullopt;
+      auto r10 = within<0.0,3.0>( *r9 );             if( !r10 ) return std::nullopt;
+      auto r11 = doSomething( *r10 );                if( !r11 ) return std::nullopt;
+      auto r12 = doSomethingElse( *r11 );            if( !r12 ) return std::nullopt;
+      auto r13 = scale<2.0>( *r12 );                 if( !r13 ) return std::nullopt;
+      auto r14 = within<0.1,20.0>( *r13 );           if( !r14 ) return std::nullopt;
+      auto r15 = reciprocal( *r14 );                 if( !r15 ) return std::nullopt;
+      return scale<100.0>( *r15 );
+   }
+
+} // namespace nested_if_solution
+#endif
+
+
+#if BENCHMARK_PIPELINE_SOLUTION
+namespace pipeline_solution {
+
+   // The same stages, composed by the 'Pipeline' combinator. Lambdas (instead of function
+   // pointers) make every stage a distinct type, which the compiler can inline.
+   constexpr auto validate =
+      pipeline( []( double d ){ return doSomething( d ); }
+              , []( double d ){ return doSomethingElse( d ); }
+              , []( double d ){ return doAThirdThing( d ); }
+              , []( double d ){ return within<0.5,4.5>( d ); }
+              , []( double d ){ return scale<4.0>( d ); } )
+      | []( double d ){ return reciprocal( d ); }
+      | []( double d ){ return within<0.05,1.0>( d ); }
+      | []( double d ){ return logarithm( d ); }
+      | []( double d ){ return scale<-1.0>( d ); }
+      | []( double d ){ return within<0.0,3.0>( d ); }
+      | []( double d ){ return doSomething( d ); }
+      | []( double d ){ return doSomethingElse( d ); }
+      | []( double d ){ return scale<2.0>( d ); }
+      | []( double d ){ return within<0.1,20.0>( d ); }
+      | []( double d ){ return reciprocal( d ); }
+      | []( double d ){ return scale<100.0>( d ); };
+
+} // namespace pipeline_solution
+#endif
+
+
+//---- <Main.cpp> ---------------------------------------------------------------------------------
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+constexpr size_t N( 1000000UL );  // Number of inputs
+constexpr size_t iterations( 100UL );  // Number of benchmark iterations
+
+
+template< typename Function >
+double measure( Function function )
+{
+   std::chrono::time_point<std::chrono::high_resolution_clock> start, end;
+   start = std::chrono::high_resolution_clock::now();
+
+   for( size_t rep=0UL; rep<iterations; ++rep ) {
+      function();
+   }
+
+   end = std::chrono::high_resolution_clock::now();
+   std::chrono::duration<double> const elapsedTime( end - start );
+   return elapsedTime.count();
+}
+
+
+void report( char const* label, double seconds, size_t valid, double sum )
+{
+   // The formatting flags are set on a local stream to leave 'std::cout' unchanged
+   std::ostringstream os;
+   os << " " << std::left << std::setw(32) << label << ": " << std::right
+      << std::setw(7) << std::setprecision(4) << seconds/(N*iterations)*1E9 << " ns/element"
+      << "  (" << valid << " valid, sum = " << std::setprecision(12) << sum << ")\n";
+   std::cout << os.str();
+}
+
+
+// Evaluates the scalar form of a 16-stage validation for all inputs
+template< typename Validate >
+void benchmark_scalar( char const* label, std::vector<double> const& input, Validate validate )
+{
+   std::vector<std::optional<double>> output( input.size() );
+
+   double const seconds = measure( [&](){
+      for( size_t i=0UL; i<input.size(); ++i ) {
+         output[i] = validate( input[i] );
+      }
+   } );
+
+   size_t valid( 0UL );
+   double sum( 0.0 );
+   for( auto const& result : output ) {
+      if( result.has_value() ) {
+         ++valid;
+         sum += *result;
+      }
+   }
+
+   report( label, seconds, valid, sum );
+}
+
+
+int main()
+{
+   std::random_device rd{};
+   unsigned int const seed( rd() );
+
+   // The inputs fail at different stages of the validation
+   std::mt19937 rng{ seed };
+   std::uniform_real_distribution<double> dist( -100.0, 200.0 );
+
+   std::vector<double> input( N );
+   for( double& d : input ) {
+      d = dist( rng );
+   }
+
+   std::cout << "\n " << N << " inputs, 16 stages\n";
+
+#if BENCHMARK_MAP_SOLUTION
+   benchmark_scalar( "Adapter_3 (map)", input, map_solution::validate );
+#endif
+
+#if BENCHMARK_NESTED_IF_SOLUTION
+   benchmark_scalar( "Nested if", input, nested_if_solution::validate );
+#endif
+
+#if BENCHMARK_PIPELINE_SOLUTION
+   benchmark_scalar( "Pipeline", input, pipeline_solution::validate );
+
+   {
+      std::vector<double> output( N );
+      std::vector<std::uint64_t> mask( ( N + 63UL ) / 64UL );
+
+      double const seconds = measure( [&](){
+         pipeline_solution::validate( std::span<double const>( input ), std::span<double>( output ), std::span<std::uint64_t>( mask ) );
+      } );
+
+      size_t valid( 0UL );
+      double sum( 0.0 );
+      for( size_t i=0UL; i<N; ++i ) {
+         if( mask[i/64UL] & ( std::uint64_t{1} << ( i % 64UL ) ) ) {
+            ++valid;
+            sum += output[i];
+         }
+      }
+
+      report( "Pipeline (batch, bitmask)", seconds, valid, sum );
+   }
+#endif
+
+   std::cout << std::endl;
+
+   return EXIT_SUCCESS;
+}
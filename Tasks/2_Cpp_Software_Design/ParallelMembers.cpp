@@ -0,0 +1,355 @@
+/**************************************************************************************************
+*
+* \file ParallelMembers.cpp
+* \brief C++ Training - Data Members Performance Benchmark for Parallel Reductions
+*
+* Copyright (C) 2015-2023 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+* Task: Copy-and-paste the following code into 'quick-bench.com' (or, preferably, run it on a
+*       multi-core machine). Benchmark the time to determine the oldest person contained in a
+*       table of Persons with 1 up to the number of available hardware threads. Compare how the
+*       layouts of 'BridgedMembers.cpp' scale with the number of threads.
+*
+**************************************************************************************************/
+
+#include <algorithm>
+#include <barrier>
+#include <climits>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#if defined(__linux__)
+#  include <pthread.h>
+#  include <sched.h>
+#endif
+
+
+//---- Benchmark configuration --------------------------------------------------------------------
+
+constexpr size_t size( 1000000 );  // Size of the generated container (exceeds the caches)
+constexpr size_t iterations( 20 );  // Number of benchmark iterations
+
+#define BENCHMARK_PERSON1 1
+#define BENCHMARK_PERSON2 1
+#define BENCHMARK_PERSON3 1
+#define BENCHMARK_PERSON4 1
+#define BENCHMARK_PERSON5 1
+#define BENCHMARK_PERSON6 1
+
+
+//---- Random Number Setup ------------------------------------------------------------------------
+
+std::random_device rd{};
+
+std::uniform_int_distribution<int> dist( 1957, 2004 );
+
+int get_random_year_of_birth()
+{
+   // Every thread constructs its own persons and therefore needs its own engine
+   thread_local std::mt19937 rng{ rd() };
+   return dist( rng );
+}
+
+
+//---- Person implementations ---------------------------------------------------------------------
+
+struct Person1
+{
+   std::string forename{ "Homer" };
+   std::string surname{ "Simpson" };
+   std::string address{ "712 Red Bark Lane" };
+   std::string zip{ "89011" };
+   std::string city{ "Henderson" };
+   std::string state{ "Nevada" };
+   int year_of_birth{ get_random_year_of_birth() };
+};
+
+int year_of_birth( Person1 const& p ) { return p.year_of_birth; }
+
+
+struct Person2
+{
+   struct Pimpl {
+      std::string forename{ "Homer" };
+      std::string surname{ "Simpson" };
+      std::string address{ "712 Red Bark Lane" };
+      std::string zip{ "89011" };
+      std::string city{ "Henderson" };
+      std::string state{ "Nevada" };
+      int year_of_birth{ get_random_year_of_birth() };
+   };
+
+   std::unique_ptr<Pimpl> pimpl{ new Pimpl{} };
+};
+
+int year_of_birth( Person2 const& p ) { return p.pimpl->year_of_birth; }
+
+
+struct Person3
+{
+   std::string forename{ "Homer" };
+   std::string surname{ "Simpson" };
+   int year_of_birth{ get_random_year_of_birth() };
+
+   struct Pimpl {
+      std::string address{ "712 Red Bark Lane" };
+      std::string zip{ "89011" };
+      std::string city{ "Henderson" };
+      std::string state{ "Nevada" };
+   };
+
+   std::unique_ptr<Pimpl> pimpl{ new Pimpl{} };
+};
+
+int year_of_birth( Person3 const& p ) { return p.year_of_birth; }
+
+
+struct Person4
+{
+   int year_of_birth{ get_random_year_of_birth() };
+
+   struct Pimpl {
+      std::string forename{ "Homer" };
+      std::string surname{ "Simpson" };
+      std::string address{ "712 Red Bark Lane" };
+      std::string zip{ "89011" };
+      std::string city{ "Henderson" };
+      std::string state{ "Nevada" };
+   };
+
+   std::unique_ptr<Pimpl> pimpl{ new Pimpl{} };
+};
+
+int year_of_birth( Person4 const& p ) { return p.year_of_birth; }
+
+
+struct Pimpl5
+{
+   std::string forename{ "Homer" };
+   std::string surname{ "Simpson" };
+   int year_of_birth{ get_random_year_of_birth() };
+   std::string address{ "712 Red Bark Lane" };
+   std::string zip{ "89011" };
+   std::string city{ "Henderson" };
+   std::string state{ "Nevada" };
+};
+
+template< typename Pimpl >
+struct Person5
+{
+   Pimpl pimpl;
+};
+
+int year_of_birth( Person5<Pimpl5> const& p ) { return p.pimpl.year_of_birth; }
+
+
+// In contrast to 'BridgedMembers.cpp', the years of birth are not stored in a static vector,
+// but in the partition owning the persons (see below)
+struct Person6
+{
+   size_t id{};
+
+   struct Pimpl {
+      std::string forename{ "Homer" };
+      std::string surname{ "Simpson" };
+      std::string address{ "712 Red Bark Lane" };
+      std::string zip{ "89011" };
+      std::string city{ "Henderson" };
+      std::string state{ "Nevada" };
+   };
+
+   std::unique_ptr<Pimpl> pimpl{ new Pimpl{} };
+};
+
+
+//---- Partitions ---------------------------------------------------------------------------------
+
+// The result of a (partial) reduction. Aligned to a cache line to avoid false sharing between the
+// partial results of different threads.
+struct alignas(64) Oldest
+{
+   int year_of_birth{ INT_MAX };
+   size_t index{};
+};
+
+bool operator<( Oldest const& a, Oldest const& b )
+{
+   return a.year_of_birth < b.year_of_birth ||
+          ( a.year_of_birth == b.year_of_birth && a.index < b.index );
+}
+
+
+// The share of the persons owned by a single thread. The partition is constructed by its thread,
+// such that all pages of the persons (including the pimpls allocated from the thread's malloc
+// arena) are first touched and therefore placed on the NUMA node of this thread.
+template< typename Person >
+struct Partition
+{
+   explicit Partition( size_t n = 0UL ) : persons( n ) {}
+
+   Oldest oldest( size_t offset ) const
+   {
+      if( persons.empty() ) return Oldest{};
+
+      auto const pos = std::min_element( begin(persons), end(persons), []( Person const& p1, Person const& p2 ){
+         return year_of_birth( p1 ) < year_of_birth( p2 );
+      } );
+      return Oldest{ year_of_birth( *pos ), offset + static_cast<size_t>( std::distance( begin(persons), pos ) ) };
+   }
+
+   std::vector<Person> persons;
+};
+
+template<>
+struct Partition<Person6>
+{
+   explicit Partition( size_t n = 0UL ) : persons( n )
+   {
+      years_of_birth.reserve( n );
+      for( size_t i=0UL; i<n; ++i ) {
+         persons[i].id = i;
+         years_of_birth.push_back( get_random_year_of_birth() );
+      }
+   }
+
+   Oldest oldest( size_t offset ) const
+   {
+      if( years_of_birth.empty() ) return Oldest{};
+
+      auto const pos = std::min_element( begin(years_of_birth), end(years_of_birth) );
+      return Oldest{ *pos, offset + static_cast<size_t>( std::distance( begin(years_of_birth), pos ) ) };
+   }
+
+   std::vector<int> years_of_birth;
+   std::vector<Person6> persons;
+};
+
+
+//---- Worker threads -----------------------------------------------------------------------------
+
+// A fixed set of threads, each pinned to one hardware thread. 'execute()' runs the given task on
+// all threads and returns as soon as all threads are done. Since every thread stays on its
+// hardware thread, it repeatedly scans the memory it has touched first.
+class Workers
+{
+ public:
+   explicit Workers( size_t n )
+      : sync_( static_cast<std::ptrdiff_t>( n+1UL ) )
+   {
+      threads_.reserve( n );
+      for( size_t t=0UL; t<n; ++t ) {
+         threads_.emplace_back( [this,t](){ run( t ); } );
+      }
+   }
+
+   ~Workers()
+   {
+      task_ = nullptr;
+      sync_.arrive_and_wait();
+   }
+
+   size_t size() const { return threads_.size(); }
+
+   void execute( std::function<void(size_t)> const& task )
+   {
+      task_ = &task;
+      sync_.arrive_and_wait();  // Start
+      sync_.arrive_and_wait();  // Finish
+   }
+
+ private:
+   void run( size_t t )
+   {
+      pin( t );
+      while( true ) {
+         sync_.arrive_and_wait();
+         if( !task_ ) return;
+         (*task_)( t );
+         sync_.arrive_and_wait();
+      }
+   }
+
+   static void pin( [[maybe_unused]] size_t t )
+   {
+#if defined(__linux__)
+      cpu_set_t set;
+      CPU_ZERO( &set );
+      CPU_SET( t % std::max( std::thread::hardware_concurrency(), 1U ), &set );
+      pthread_setaffinity_np( pthread_self(), sizeof(set), &set );
+#endif
+   }
+
+   std::function<void(size_t)> const* task_{};
+   std::barrier<> sync_;
+   std::vector<std::jthread> threads_;  // Declared last to be joined first
+};
+
+
+//---- Benchmark ----------------------------------------------------------------------------------
+
+template< typename Person >
+static void determineOldestPerson(benchmark::State& state)
+{
+   size_t const threads( static_cast<size_t>( state.range(0) ) );
+   size_t const chunk( ( size + threads - 1UL ) / threads );
+
+   auto const offset = [&]( size_t t ){ return std::min( t*chunk, size ); };
+
+   Workers workers( threads );
+   std::vector< Partition<Person> > partitions( threads );
+   std::vector<Oldest> results( threads );
+
+   // First touch: Every thread constructs its own partition
+   workers.execute( [&]( size_t t ){
+      partitions[t] = Partition<Person>( offset(t+1UL) - offset(t) );
+   } );
+
+   std::function<void(size_t)> const reduce = [&]( size_t t ){
+      results[t] = partitions[t].oldest( offset(t) );
+   };
+
+   for( auto _ : state )
+   {
+      workers.execute( reduce );
+      benchmark::DoNotOptimize( std::min_element( begin(results), end(results) )->index );
+   }
+
+   state.counters["persons/s/thread"] =
+      benchmark::Counter( static_cast<double>( size ) / threads, benchmark::Counter::kIsIterationInvariantRate );
+}
+
+static void threads(benchmark::internal::Benchmark* b)
+{
+   unsigned int const max_threads( std::max( std::thread::hardware_concurrency(), 1U ) );
+   for( unsigned int t=1U; t<max_threads; t*=2U ) {
+      b->Arg( t );
+   }
+   b->Arg( max_threads );
+}
+
+#if BENCHMARK_PERSON1
+BENCHMARK_TEMPLATE(determineOldestPerson,Person1)->Apply(threads)->Iterations(iterations)->UseRealTime();
+#endif
+#if BENCHMARK_PERSON2
+BENCHMARK_TEMPLATE(determineOldestPerson,Person2)->Apply(threads)->Iterations(iterations)->UseRealTime();
+#endif
+#if BENCHMARK_PERSON3
+BENCHMARK_TEMPLATE(determineOldestPerson,Person3)->Apply(threads)->Iterations(iterations)->UseRealTime();
+#endif
+#if BENCHMARK_PERSON4
+BENCHMARK_TEMPLATE(determineOldestPerson,Person4)->Apply(threads)->Iterations(iterations)->UseRealTime();
+#endif
+#if BENCHMARK_PERSON5
+BENCHMARK_TEMPLATE(determineOldestPerson,Person5<Pimpl5>)->Apply(threads)->Iterations(iterations)->UseRealTime();
+#endif
+#if BENCHMARK_PERSON6
+BENCHMARK_TEMPLATE(determineOldestPerson,Person6)->Apply(threads)->Iterations(iterations)->UseRealTime();
+#endif
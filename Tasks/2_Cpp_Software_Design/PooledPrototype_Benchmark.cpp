@@ -0,0 +1,507 @@
+/**************************************************************************************************
+*
+* \file PooledPrototype_Benchmark.cpp
+* \brief C++ Training - Benchmark for the Prototype Design Pattern (Entity Spawner)
+*
+* Copyright (C) 2015-2023 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#define BENCHMARK_CLASSIC_SOLUTION 1
+#define BENCHMARK_POOLED_SOLUTION 1
+
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <random>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+
+//---- Spawn schedule -----------------------------------------------------------------------------
+
+constexpr size_t frames( 1000UL );  // Number of simulated frames
+constexpr size_t batches( 200UL );  // Number of spawned batches per frame
+constexpr size_t max_batch_size( 50UL );  // Maximum number of clones per batch
+constexpr size_t max_lifetime( 60UL );  // Maximum lifetime of a clone (in frames)
+
+
+// A batch of clones of the same prototype, which are despawned after the same number of frames
+struct Batch
+{
+   std::uint32_t prototype{};
+   std::uint32_t count{};
+   std::uint32_t lifetime{};
+};
+
+std::vector<Batch> generate_schedule( size_t prototypes, unsigned int seed )
+{
+   std::mt19937 rng{ seed };
+   std::uniform_int_distribution<std::uint32_t> prototype_dist( 0U, static_cast<std::uint32_t>( prototypes-1UL ) );
+   std::uniform_int_distribution<std::uint32_t> count_dist( 1U, max_batch_size );
+   std::uniform_int_distribution<std::uint32_t> lifetime_dist( 1U, max_lifetime );
+
+   std::vector<Batch> schedule( frames*batches );
+   for( auto& batch : schedule ) {
+      batch = Batch{ prototype_dist(rng), count_dist(rng), lifetime_dist(rng) };
+   }
+   return schedule;
+}
+
+
+#if BENCHMARK_CLASSIC_SOLUTION
+namespace classic_solution {
+
+   // The design of 'Prototype.cpp': Every clone is a separate dynamic allocation
+
+   class Animal
+   {
+    public:
+      virtual ~Animal() = default;
+      virtual void update() = 0;
+      virtual int age() const = 0;
+      virtual std::unique_ptr<Animal> clone() const = 0;
+   };
+
+   using AnimalPtr = std::unique_ptr<Animal>;
+
+   class Dog : public Animal
+   {
+    public:
+      void update() override { ++age_; x_ += 1.0F; }
+      int age() const override { return age_; }
+      AnimalPtr clone() const override { return std::make_unique<Dog>( *this ); }
+
+    private:
+      float x_{}, y_{};
+      int age_{};
+   };
+
+   class Cat : public Animal
+   {
+    public:
+      void update() override { ++age_; y_ += 1.0F; }
+      int age() const override { return age_; }
+      AnimalPtr clone() const override { return std::make_unique<Cat>( *this ); }
+
+    private:
+      float x_{}, y_{};
+      int age_{};
+      int lives_{ 9 };
+   };
+
+   class Bird : public Animal
+   {
+    public:
+      void update() override { ++age_; path_[age_ % path_.size()] += 1.0F; }
+      int age() const override { return age_; }
+      AnimalPtr clone() const override { return std::make_unique<Bird>( *this ); }
+
+    private:
+      std::array<float,12> path_{};
+      int age_{};
+   };
+
+   class PrototypeRegistry
+   {
+    public:
+      size_t add( AnimalPtr prototype )
+      {
+         prototypes_.push_back( std::move(prototype) );
+         return prototypes_.size() - 1UL;
+      }
+
+      AnimalPtr clone( size_t id ) const { return prototypes_[id]->clone(); }
+
+    private:
+      std::vector<AnimalPtr> prototypes_;
+   };
+
+   PrototypeRegistry make_registry()
+   {
+      PrototypeRegistry registry{};
+      registry.add( std::make_unique<Dog>() );
+      registry.add( std::make_unique<Cat>() );
+      registry.add( std::make_unique<Bird>() );
+      return registry;
+   }
+
+} // namespace classic_solution
+#endif
+
+
+#if BENCHMARK_POOLED_SOLUTION
+namespace pooled_solution {
+
+   // A pool of objects of type 'T'. The objects are stored in chunks of slots. Freed slots are
+   // kept in an intrusive free list and reused by subsequent allocations. Note that the pool is
+   // not thread-safe and that all objects have to be destroyed before the pool.
+   template< typename T >
+   class ObjectPool
+   {
+    public:
+      static constexpr size_t chunk_size = 1024UL;
+
+      ObjectPool() = default;
+      ObjectPool( ObjectPool const& ) = delete;
+      ObjectPool& operator=( ObjectPool const& ) = delete;
+
+      T* create( T const& prototype )
+      {
+         return construct( free_ ? pop() : allocate( 1UL ), prototype );
+      }
+
+      // Creates 'n' copies of the prototype and passes them to 'out'. Freed slots are reused first,
+      // all remaining copies are created in contiguous, previously unused slots. Since the clones
+      // of a batch are typically destroyed together, the freed slots mostly form contiguous runs.
+      template< typename Out >
+      void create_n( size_t n, T const& prototype, Out out )
+      {
+         for( ; n>0UL && free_; --n ) {
+            out( construct( pop(), prototype ) );
+         }
+
+         if( n == 0UL ) return;
+
+         Slot* const slots( allocate( n ) );
+         size_t i( 0UL );
+         try {
+            for( ; i<n; ++i ) {
+               out( ::new( static_cast<void*>( slots+i ) ) T( prototype ) );
+            }
+         }
+         catch( ... ) {
+            for( ; i<n; ++i ) push( slots+i );
+            throw;
+         }
+      }
+
+      void destroy( T* object ) noexcept
+      {
+         std::destroy_at( object );
+         push( reinterpret_cast<Slot*>( object ) );
+      }
+
+    private:
+      union Slot
+      {
+         Slot* next;
+         alignas(T) std::byte storage[sizeof(T)];
+      };
+
+      T* construct( Slot* slot, T const& prototype )
+      {
+         try {
+            return ::new( static_cast<void*>( slot ) ) T( prototype );
+         }
+         catch( ... ) {
+            push( slot );
+            throw;
+         }
+      }
+
+      Slot* pop() noexcept
+      {
+         Slot* const slot( free_ );
+         free_ = slot->next;
+         return slot;
+      }
+
+      void push( Slot* slot ) noexcept
+      {
+         slot->next = free_;
+         free_ = slot;
+      }
+
+      // Returns 'n' contiguous, unused slots
+      Slot* allocate( size_t n )
+      {
+         if( used_ + n > capacity_ )
+         {
+            // The rest of the current chunk is not lost, but added to the free list
+            for( ; used_<capacity_; ++used_ ) {
+               push( chunks_.back().get() + used_ );
+            }
+
+            capacity_ = std::max( n, chunk_size );
+            chunks_.push_back( std::make_unique_for_overwrite<Slot[]>( capacity_ ) );
+            used_ = 0UL;
+         }
+
+         Slot* const slots( chunks_.back().get() + used_ );
+         used_ += n;
+         return slots;
+      }
+
+      std::vector< std::unique_ptr<Slot[]> > chunks_;
+      size_t used_{};
+      size_t capacity_{};
+      Slot* free_{};
+   };
+
+
+   class Animal;
+
+   // Returns an animal to the pool of its concrete type
+   struct Recycle
+   {
+      void operator()( Animal* animal ) const noexcept;
+   };
+
+   using AnimalPtr = std::unique_ptr<Animal,Recycle>;
+
+   class Animal
+   {
+    public:
+      virtual ~Animal() = default;
+      virtual void update() = 0;
+      virtual int age() const = 0;
+      virtual AnimalPtr clone() const = 0;
+      virtual void clone_n( size_t n, std::vector<AnimalPtr>& clones ) const = 0;
+      virtual void recycle() noexcept = 0;
+   };
+
+   void Recycle::operator()( Animal* animal ) const noexcept
+   {
+      animal->recycle();
+   }
+
+
+   // Implements the cloning of the concrete animal type 'Derived' in terms of an object pool. All
+   // clones are created in the pool of their prototype.
+   template< typename Derived >
+   class Pooled : public Animal
+   {
+    public:
+      explicit Pooled( ObjectPool<Derived>& pool ) : pool_( &pool ) {}
+
+      AnimalPtr clone() const override
+      {
+         return AnimalPtr( pool_->create( self() ) );
+      }
+
+      void clone_n( size_t n, std::vector<AnimalPtr>& clones ) const override
+      {
+         if( clones.capacity() - clones.size() < n ) {
+            clones.reserve( std::max( clones.size() + n, 2UL*clones.capacity() ) );
+         }
+         pool_->create_n( n, self(), [&clones]( Derived* clone ){ clones.emplace_back( clone ); } );
+      }
+
+      void recycle() noexcept override
+      {
+         pool_->destroy( static_cast<Derived*>( this ) );
+      }
+
+    private:
+      Derived const& self() const { return static_cast<Derived const&>( *this ); }
+
+      ObjectPool<Derived>* pool_{};
+   };
+
+   class Dog : public Pooled<Dog>
+   {
+    public:
+      using Pooled<Dog>::Pooled;
+
+      void update() override { ++age_; x_ += 1.0F; }
+      int age() const override { return age_; }
+
+    private:
+      float x_{}, y_{};
+      int age_{};
+   };
+
+   class Cat : public Pooled<Cat>
+   {
+    public:
+      using Pooled<Cat>::Pooled;
+
+      void update() override { ++age_; y_ += 1.0F; }
+      int age() const override { return age_; }
+
+    private:
+      float x_{}, y_{};
+      int age_{};
+      int lives_{ 9 };
+   };
+
+   class Bird : public Pooled<Bird>
+   {
+    public:
+      using Pooled<Bird>::Pooled;
+
+      void update() override { ++age_; path_[age_ % path_.size()] += 1.0F; }
+      int age() const override { return age_; }
+
+    private:
+      std::array<float,12> path_{};
+      int age_{};
+   };
+
+   // The registry owns the pools of its prototypes, i.e. the clones of different registries never
+   // share any slots. All clones have to be destroyed before the registry.
+   class PrototypeRegistry
+   {
+    public:
+      // Creates a new pool for the concrete animal type 'T' and a prototype within this pool
+      template< typename T >
+      size_t add()
+      {
+         auto pool( std::make_shared<ObjectPool<T>>() );
+         prototypes_.push_back( AnimalPtr( pool->create( T{ *pool } ) ) );
+         pools_.push_back( std::move(pool) );
+         return prototypes_.size() - 1UL;
+      }
+
+      AnimalPtr clone( size_t id ) const { return prototypes_[id]->clone(); }
+
+      void clone_n( size_t id, size_t n, std::vector<AnimalPtr>& clones ) const
+      {
+         prototypes_[id]->clone_n( n, clones );
+      }
+
+    private:
+      std::vector< std::shared_ptr<void> > pools_;  // Declared first to outlive the prototypes
+      std::vector<AnimalPtr> prototypes_;
+   };
+
+   PrototypeRegistry make_registry()
+   {
+      PrototypeRegistry registry{};
+      registry.add<Dog>();
+      registry.add<Cat>();
+      registry.add<Bird>();
+      return registry;
+   }
+
+} // namespace pooled_solution
+#endif
+
+
+//---- Benchmark ----------------------------------------------------------------------------------
+
+// Clones every animal of a batch separately
+struct CloneEach
+{
+   template< typename Registry, typename Clones >
+   void operator()( Registry const& registry, Batch const& batch, Clones& clones ) const
+   {
+      for( std::uint32_t i=0U; i<batch.count; ++i ) {
+         clones.push_back( registry.clone( batch.prototype ) );
+      }
+   }
+};
+
+// Clones all animals of a batch at once
+struct CloneBatch
+{
+   template< typename Registry, typename Clones >
+   void operator()( Registry const& registry, Batch const& batch, Clones& clones ) const
+   {
+      registry.clone_n( batch.prototype, batch.count, clones );
+   }
+};
+
+
+// Simulates all frames: Every frame despawns all expired animals, spawns the scheduled batches,
+// and updates all living animals. The spawning and the updates are timed separately.
+template< typename Registry, typename Spawn >
+void benchmark( char const* label, Registry const& registry, std::vector<Batch> const& schedule, Spawn spawn )
+{
+   using AnimalPtr = decltype( registry.clone( 0UL ) );
+
+   // The living animals, grouped by the frame of their despawning
+   std::vector< std::vector<AnimalPtr> > buckets( max_lifetime+1UL );
+
+   std::chrono::duration<double> spawning{}, updating{};
+   size_t clones( 0UL ), updates( 0UL );
+   long long total_age( 0LL );
+
+   for( size_t frame=0UL; frame<frames; ++frame )
+   {
+      auto const start( std::chrono::high_resolution_clock::now() );
+
+      buckets[frame % buckets.size()].clear();
+
+      for( size_t b=frame*batches; b<(frame+1UL)*batches; ++b ) {
+         Batch const& batch( schedule[b] );
+         spawn( registry, batch, buckets[( frame + batch.lifetime ) % buckets.size()] );
+         clones += batch.count;
+      }
+
+      auto const middle( std::chrono::high_resolution_clock::now() );
+
+      for( auto& bucket : buckets ) {
+         for( auto& animal : bucket ) {
+            animal->update();
+         }
+         updates += bucket.size();
+      }
+
+      auto const end( std::chrono::high_resolution_clock::now() );
+
+      spawning += middle - start;
+      updating += end - middle;
+   }
+
+   for( auto const& bucket : buckets ) {
+      for( auto const& animal : bucket ) {
+         total_age += animal->age();
+      }
+   }
+
+   // The formatting flags are set on a local stream to leave 'std::cout' unchanged
+   std::ostringstream os;
+   os << " " << std::left << std::setw(28) << label << ": " << std::setprecision(4)
+      << std::setw(6) << spawning.count()/clones*1E9 << " ns/clone, "
+      << std::setw(6) << updating.count()/updates*1E9 << " ns/update"
+      << "  (total age = " << total_age << ")\n";
+   std::cout << os.str();
+}
+
+
+int main()
+{
+   std::random_device rd{};
+   unsigned int const seed( rd() );
+
+   std::vector<Batch> const schedule( generate_schedule( 3UL, seed ) );
+
+   std::cout << "\n";
+
+#if BENCHMARK_CLASSIC_SOLUTION
+   {
+      auto const registry( classic_solution::make_registry() );
+      benchmark( "std::make_unique", registry, schedule, CloneEach{} );
+   }
+#endif
+
+#if BENCHMARK_POOLED_SOLUTION
+   // Every run starts with a new registry and therefore with empty pools
+   {
+      auto const registry( pooled_solution::make_registry() );
+      benchmark( "Object pool (clone)", registry, schedule, CloneEach{} );
+   }
+   {
+      auto const registry( pooled_solution::make_registry() );
+      benchmark( "Object pool (clone_n)", registry, schedule, CloneBatch{} );
+   }
+#endif
+
+   std::cout << std::endl;
+
+   return EXIT_SUCCESS;
+}
@@ -0,0 +1,592 @@
+/**************************************************************************************************
+*
+* \file RenderCommands_Benchmark.cpp
+* \brief C++ Training - Benchmark for Immediate Drawing and Drawing via a Render Command Buffer
+*
+* Copyright (C) 2015-2023 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#define BENCHMARK_IMMEDIATE_SOLUTION 1
+#define BENCHMARK_COMMAND_BUFFER_SOLUTION 1
+
+
+//---- <GraphicsLibrary.h> (external) -------------------------------------------------------------
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+enum class Color : std::uint32_t
+{
+   red   = 0xFF0000,
+   green = 0x00FF00,
+   blue  = 0x0000FF
+};
+
+std::string to_string( Color color )
+{
+   switch( color ) {
+      case Color::red:
+         return "red (0xFF0000)";
+      case Color::green:
+         return "green (0x00FF00)";
+      case Color::blue:
+         return "blue (0x0000FF)";
+      default:
+         return "unknown";
+   }
+}
+
+
+//---- <Point.h> ----------------------------------------------------------------------------------
+
+struct Point
+{
+   double x;
+   double y;
+};
+
+
+//---- <Framebuffer.h> ----------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <span>
+#include <utility>
+#include <vector>
+
+// A framebuffer in memory with one 32-bit pixel (0x00RRGGBB) per pixel. A pixel is covered by a
+// shape if the center of the pixel lies within the shape.
+class Framebuffer
+{
+ public:
+   Framebuffer( size_t width, size_t height )
+      : width_( width )
+      , height_( height )
+      , pixels_( width*height, background )
+   {}
+
+   void clear() { std::fill( begin(pixels_), end(pixels_), background ); }
+
+   void fill_circle( Point center, double radius, std::uint32_t color )
+   {
+      auto const [y0,y1] = rows( center.y, radius );
+      for( std::ptrdiff_t y=y0; y<y1; ++y ) {
+         double const dy( static_cast<double>(y) + 0.5 - center.y );
+         double const dx2( radius*radius - dy*dy );
+         if( dx2 >= 0.0 ) fill_span( y, center.x, std::sqrt( dx2 ), color );
+      }
+   }
+
+   void fill_square( Point center, double side, std::uint32_t color )
+   {
+      auto const [y0,y1] = rows( center.y, 0.5*side );
+      for( std::ptrdiff_t y=y0; y<y1; ++y ) {
+         fill_span( y, center.x, 0.5*side, color );
+      }
+   }
+
+   // An order-dependent hash of all pixels, which is identical only for identical images
+   std::uint64_t checksum() const
+   {
+      std::uint64_t hash( 14695981039346656037UL );
+      for( std::uint32_t p : pixels_ ) {
+         hash = ( hash ^ p ) * 1099511628211UL;
+      }
+      return hash;
+   }
+
+   static constexpr std::uint32_t background = 0xFF000000;
+
+ private:
+   // The range of rows whose pixel centers lie within [center-half,center+half]
+   std::pair<std::ptrdiff_t,std::ptrdiff_t> rows( double center, double half ) const
+   {
+      return { clamp( std::ceil( center - half - 0.5 ), height_ ),
+               clamp( std::floor( center + half - 0.5 ) + 1.0, height_ ) };
+   }
+
+   void fill_span( std::ptrdiff_t y, double center, double half, std::uint32_t color )
+   {
+      std::ptrdiff_t const x0( clamp( std::ceil( center - half - 0.5 ), width_ ) );
+      std::ptrdiff_t const x1( clamp( std::floor( center + half - 0.5 ) + 1.0, width_ ) );
+      if( x0 < x1 ) {
+         std::fill( pixels_.data() + y*static_cast<std::ptrdiff_t>(width_) + x0,
+                    pixels_.data() + y*static_cast<std::ptrdiff_t>(width_) + x1, color );
+      }
+   }
+
+   static std::ptrdiff_t clamp( double value, size_t limit )
+   {
+      return static_cast<std::ptrdiff_t>( std::clamp( value, 0.0, static_cast<double>(limit) ) );
+   }
+
+   size_t width_;
+   size_t height_;
+   std::vector<std::uint32_t> pixels_;
+};
+
+
+#include <ostream>
+
+#if BENCHMARK_IMMEDIATE_SOLUTION
+namespace immediate_solution {
+
+   // The drawing of 'ObjectOriented.cpp': Every shape is drawn immediately by a virtual function
+   // call. The target (text output or framebuffer) is an abstract 'Renderer'.
+
+   class Renderer
+   {
+    public:
+      virtual ~Renderer() = default;
+
+      virtual void draw_circle( double radius, Point center, Color color ) = 0;
+      virtual void draw_square( double side, Point center, Color color ) = 0;
+   };
+
+   class Shape
+   {
+    public:
+      virtual ~Shape() = default;
+
+      virtual void draw( Renderer& renderer ) const = 0;
+   };
+
+   class Circle : public Shape
+   {
+    public:
+      Circle( double radius, Point center, Color color )
+         : radius_( radius ), center_( center ), color_( color )
+      {}
+
+      void draw( Renderer& renderer ) const override { renderer.draw_circle( radius_, center_, color_ ); }
+
+    private:
+      double radius_;
+      Point center_;
+      Color color_;
+   };
+
+   class Square : public Shape
+   {
+    public:
+      Square( double side, Point center, Color color )
+         : side_( side ), center_( center ), color_( color )
+      {}
+
+      void draw( Renderer& renderer ) const override { renderer.draw_square( side_, center_, color_ ); }
+
+    private:
+      double side_;
+      Point center_;
+      Color color_;
+   };
+
+   // Writes every shape to the given stream, as 'std::cout' does for an interactive terminal:
+   // Every line is flushed, i.e. every shape results in a synchronous write
+   class TextRenderer : public Renderer
+   {
+    public:
+      explicit TextRenderer( std::ostream& os ) : os_( os ) {}
+
+      void draw_circle( double radius, Point center, Color color ) override
+      {
+         os_ << "circle: radius=" << radius << ", center=(" << center.x << "," << center.y
+             << "), color = " << to_string(color) << std::endl;
+      }
+
+      void draw_square( double side, Point center, Color color ) override
+      {
+         os_ << "square: side=" << side << ", center=(" << center.x << "," << center.y
+             << "), color = " << to_string(color) << std::endl;
+      }
+
+    private:
+      std::ostream& os_;
+   };
+
+   class FramebufferRenderer : public Renderer
+   {
+    public:
+      explicit FramebufferRenderer( Framebuffer& fb ) : fb_( fb ) {}
+
+      void draw_circle( double radius, Point center, Color color ) override
+      {
+         fb_.fill_circle( center, radius, static_cast<std::uint32_t>( color ) );
+      }
+
+      void draw_square( double side, Point center, Color color ) override
+      {
+         fb_.fill_square( center, side, static_cast<std::uint32_t>( color ) );
+      }
+
+    private:
+      Framebuffer& fb_;
+   };
+
+} // namespace immediate_solution
+#endif
+
+
+#if BENCHMARK_COMMAND_BUFFER_SOLUTION
+namespace command_buffer_solution {
+
+   //---- <DrawCommand.h> -------------------------------------------------------------------------
+
+   // A compact (24 byte) draw record. The layer, the shape type, and the color are combined into
+   // a single key, by which the commands are sorted. The layer is the most significant part of
+   // the key, i.e. a layer is drawn completely before the next layer (painter's order).
+   struct DrawCommand
+   {
+      enum Type : std::uint32_t { circle = 0U, square = 1U };
+
+      static constexpr std::uint64_t key( std::uint32_t layer, Type type, Color color )
+      {
+         return ( std::uint64_t{ layer } << 32U ) | ( type << 24U ) | static_cast<std::uint32_t>( color );
+      }
+
+      std::uint32_t layer() const { return static_cast<std::uint32_t>( key_ >> 32U ); }
+      Type  type()  const { return static_cast<Type>( ( key_ >> 24U ) & 0xFFU ); }
+      Color color() const { return static_cast<Color>( key_ & 0xFFFFFFU ); }
+      Point center() const { return Point{ x_, y_ }; }
+      double size() const { return size_; }  // The radius of a circle, the side of a square
+
+      std::uint64_t key_;
+      float x_;
+      float y_;
+      float size_;
+   };
+
+   static_assert( sizeof(DrawCommand) == 24UL );
+
+
+   //---- <CommandBuffer.h> -----------------------------------------------------------------------
+
+   //#include <DrawCommand.h>
+
+   // A preallocated buffer of draw commands. 'clear()' keeps the capacity, such that in a render
+   // loop no allocation takes place once the buffer has reached its working size.
+   class CommandBuffer
+   {
+    public:
+      explicit CommandBuffer( size_t capacity ) { commands_.reserve( capacity ); }
+
+      void push( std::uint32_t layer, DrawCommand::Type type, Point center, double size, Color color )
+      {
+         commands_.push_back( DrawCommand{ DrawCommand::key( layer, type, color )
+                                         , static_cast<float>( center.x )
+                                         , static_cast<float>( center.y )
+                                         , static_cast<float>( size ) } );
+      }
+
+      // Sorts the commands by layer, type, and color. The sort is stable, i.e. within a group of
+      // equal layer, type, and color, the commands keep the order in which they were recorded.
+      // Note that within a layer, commands of different type or color change their relative
+      // order. The result is identical to drawing in recording order only if the shapes within a
+      // layer do not overlap.
+      void sort()
+      {
+         std::stable_sort( begin(commands_), end(commands_),
+                           []( DrawCommand const& a, DrawCommand const& b ){ return a.key_ < b.key_; } );
+      }
+
+      void clear() { commands_.clear(); }
+
+      std::span<DrawCommand const> commands() const { return commands_; }
+
+    private:
+      std::vector<DrawCommand> commands_;
+   };
+
+
+   //---- <Shapes.h> ------------------------------------------------------------------------------
+
+   // The shapes don't draw themselves anymore, but only record a draw command
+   class Shape
+   {
+    public:
+      virtual ~Shape() = default;
+
+      virtual void draw( CommandBuffer& buffer ) const = 0;
+   };
+
+   class Circle : public Shape
+   {
+    public:
+      Circle( double radius, Point center, Color color, std::uint32_t layer )
+         : radius_( radius ), center_( center ), color_( color ), layer_( layer )
+      {}
+
+      void draw( CommandBuffer& buffer ) const override { buffer.push( layer_, DrawCommand::circle, center_, radius_, color_ ); }
+
+    private:
+      double radius_;
+      Point center_;
+      Color color_;
+      std::uint32_t layer_;
+   };
+
+   class Square : public Shape
+   {
+    public:
+      Square( double side, Point center, Color color, std::uint32_t layer )
+         : side_( side ), center_( center ), color_( color ), layer_( layer )
+      {}
+
+      void draw( CommandBuffer& buffer ) const override { buffer.push( layer_, DrawCommand::square, center_, side_, color_ ); }
+
+    private:
+      double side_;
+      Point center_;
+      Color color_;
+      std::uint32_t layer_;
+   };
+
+
+   //---- <Backends.h> ----------------------------------------------------------------------------
+
+   // Writes all commands in bulk and flushes the stream once per frame. Since the commands are
+   // sorted, the name of the shape and of the color are formatted once per group.
+   class TextBackend
+   {
+    public:
+      explicit TextBackend( std::ostream& os ) : os_( os ) {}
+
+      void render( std::span<DrawCommand const> commands )
+      {
+         for( size_t i=0UL; i<commands.size(); )
+         {
+            std::uint64_t const key( commands[i].key_ );
+            bool const circle( commands[i].type() == DrawCommand::circle );
+            std::string const color( to_string( commands[i].color() ) );
+
+            for( ; i<commands.size() && commands[i].key_ == key; ++i ) {
+               Point const center( commands[i].center() );
+               os_ << ( circle ? "circle: radius=" : "square: side=" ) << commands[i].size()
+                   << ", center=(" << center.x << "," << center.y << "), color = " << color << '\n';
+            }
+         }
+         os_.flush();
+      }
+
+    private:
+      std::ostream& os_;
+   };
+
+   class FramebufferBackend
+   {
+    public:
+      explicit FramebufferBackend( Framebuffer& fb ) : fb_( fb ) {}
+
+      void render( std::span<DrawCommand const> commands )
+      {
+         for( size_t i=0UL; i<commands.size(); )
+         {
+            std::uint64_t const key( commands[i].key_ );
+            std::uint32_t const color( static_cast<std::uint32_t>( commands[i].color() ) );
+            size_t const first( i );
+            while( i<commands.size() && commands[i].key_ == key ) ++i;
+
+            // A single, non-virtual loop per group of equal type and color
+            if( commands[first].type() == DrawCommand::circle ) {
+               for( auto const& c : commands.subspan( first, i-first ) ) fb_.fill_circle( c.center(), c.size(), color );
+            }
+            else {
+               for( auto const& c : commands.subspan( first, i-first ) ) fb_.fill_square( c.center(), c.size(), color );
+            }
+         }
+      }
+
+    private:
+      Framebuffer& fb_;
+   };
+
+} // namespace command_buffer_solution
+#endif
+
+
+//---- <Main.cpp> ---------------------------------------------------------------------------------
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <random>
+
+constexpr size_t N( 10000UL );  // Number of shapes
+constexpr size_t width( 1024UL );  // Width of the framebuffer
+constexpr size_t height( 768UL );  // Height of the framebuffer
+constexpr size_t text_frames( 20UL );  // Number of frames of the text output benchmark
+constexpr size_t framebuffer_frames( 100UL );  // Number of frames of the framebuffer benchmark
+
+
+constexpr size_t cell( 32UL );  // Width and height of the cell of a shape within its layer
+
+
+// The input of all solutions. The scene consists of several layers, which cover the entire
+// framebuffer. Within a layer, every shape lies in its own cell of the layer, i.e. the shapes of
+// a layer don't overlap. Shapes of different layers do overlap. The shapes are ordered by layer,
+// such that drawing in scene order and drawing sorted by layer give the same image. All sizes and
+// coordinates are multiples of 0.25 and thus exactly representable as 'float'.
+struct ShapeData { bool circle; double size; Point center; Color color; std::uint32_t layer; };
+
+std::vector<ShapeData> generate_shapes( unsigned int seed )
+{
+   std::mt19937 rng{ seed };
+   std::bernoulli_distribution circle( 0.5 );
+   std::uniform_int_distribution<int> size( 2, 20 );  // The diameter of a circle, the side of a square
+   std::uniform_int_distribution<int> offset( -16, 16 );  // The offset from the cell center (in 1/4 pixels)
+   std::uniform_int_distribution<int> color( 0, 2 );
+
+   constexpr Color colors[] = { Color::red, Color::green, Color::blue };
+
+   size_t const columns( width / cell );
+   size_t const cells( columns * ( height / cell ) );
+
+   std::vector<size_t> order( cells );
+   std::vector<ShapeData> shapes;
+
+   for( size_t i=0UL; i<N; ++i )
+   {
+      // Every layer visits its cells in a different order
+      if( i % cells == 0UL ) {
+         std::iota( begin(order), end(order), 0UL );
+         std::shuffle( begin(order), end(order), rng );
+      }
+
+      size_t const c( order[i % cells] );
+      Point const center{ static_cast<double>( (c%columns)*cell + cell/2UL ) + 0.25*offset(rng),
+                          static_cast<double>( (c/columns)*cell + cell/2UL ) + 0.25*offset(rng) };
+      bool const is_circle( circle(rng) );
+      double const s( is_circle ? 0.5*size(rng) : 1.0*size(rng) );
+
+      shapes.push_back( ShapeData{ is_circle, s, center, colors[color(rng)], static_cast<std::uint32_t>( i / cells ) } );
+   }
+
+   return shapes;
+}
+
+
+template< typename Function >
+double measure( size_t frames, Function function )
+{
+   std::chrono::time_point<std::chrono::high_resolution_clock> start, end;
+   start = std::chrono::high_resolution_clock::now();
+
+   for( size_t frame=0UL; frame<frames; ++frame ) {
+      function();
+   }
+
+   end = std::chrono::high_resolution_clock::now();
+   std::chrono::duration<double> const elapsedTime( end - start );
+   return elapsedTime.count() / frames;
+}
+
+
+template< typename Checksum >
+void report( char const* label, double seconds, char const* name, Checksum checksum )
+{
+   // The formatting flags are set on a local stream to leave 'std::cout' unchanged
+   std::ostringstream os;
+   os << " " << std::left << std::setw(36) << label << ": " << std::right
+      << std::setw(8) << std::setprecision(4) << seconds*1E3 << " ms/frame"
+      << "  (" << name << " = " << checksum << ")\n";
+   std::cout << os.str();
+}
+
+
+int main()
+{
+   std::random_device rd{};
+   unsigned int const seed( rd() );
+
+   std::vector<ShapeData> const data( generate_shapes( seed ) );
+   auto const path( std::filesystem::temp_directory_path() / "render_commands.txt" );
+
+   std::cout << "\n " << N << " shapes, " << width << "x" << height << " framebuffer\n";
+
+#if BENCHMARK_IMMEDIATE_SOLUTION
+   {
+      using namespace immediate_solution;
+
+      std::vector<std::unique_ptr<Shape>> shapes;
+      for( auto const& s : data ) {
+         if( s.circle ) shapes.push_back( std::make_unique<Circle>( s.size, s.center, s.color ) );
+         else shapes.push_back( std::make_unique<Square>( s.size, s.center, s.color ) );
+      }
+
+      {
+         std::ofstream file( path );
+         TextRenderer renderer( file );
+         double const seconds = measure( text_frames, [&](){
+            for( auto const& shape : shapes ) shape->draw( renderer );
+         } );
+         report( "Immediate (text, flush per shape)", seconds, "bytes", static_cast<size_t>( file.tellp() ) / text_frames );
+      }
+
+      {
+         Framebuffer fb( width, height );
+         FramebufferRenderer renderer( fb );
+         double const seconds = measure( framebuffer_frames, [&](){
+            fb.clear();
+            for( auto const& shape : shapes ) shape->draw( renderer );
+         } );
+         report( "Immediate (framebuffer)", seconds, "checksum", fb.checksum() );
+      }
+   }
+#endif
+
+#if BENCHMARK_COMMAND_BUFFER_SOLUTION
+   {
+      using namespace command_buffer_solution;
+
+      std::vector<std::unique_ptr<Shape>> shapes;
+      for( auto const& s : data ) {
+         if( s.circle ) shapes.push_back( std::make_unique<Circle>( s.size, s.center, s.color, s.layer ) );
+         else shapes.push_back( std::make_unique<Square>( s.size, s.center, s.color, s.layer ) );
+      }
+
+      CommandBuffer buffer( N );
+
+      {
+         std::ofstream file( path );
+         TextBackend backend( file );
+         double const seconds = measure( text_frames, [&](){
+            buffer.clear();
+            for( auto const& shape : shapes ) shape->draw( buffer );
+            buffer.sort();
+            backend.render( buffer.commands() );
+         } );
+         report( "Command buffer (text, bulk)", seconds, "bytes", static_cast<size_t>( file.tellp() ) / text_frames );
+      }
+
+      {
+         Framebuffer fb( width, height );
+         FramebufferBackend backend( fb );
+         double const seconds = measure( framebuffer_frames, [&](){
+            fb.clear();
+            buffer.clear();
+            for( auto const& shape : shapes ) shape->draw( buffer );
+            buffer.sort();
+            backend.render( buffer.commands() );
+         } );
+         report( "Command buffer (framebuffer)", seconds, "checksum", fb.checksum() );
+      }
+   }
+#endif
+
+   std::filesystem::remove( path );
+
+   std::cout << std::endl;
+
+   return EXIT_SUCCESS;
+}
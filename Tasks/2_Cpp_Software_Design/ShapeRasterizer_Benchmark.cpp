@@ -0,0 +1,825 @@
+/**************************************************************************************************
+*
+* \file ShapeRasterizer_Benchmark.cpp
+* \brief C++ Training - Benchmark for a Tiled Software Rasterizer for Shapes
+*
+* Copyright (C) 2015-2023 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#define BENCHMARK_EXTERNAL_POLYMORPHISM_SOLUTION 1
+#define BENCHMARK_VARIANT_SOLUTION 1
+#define BENCHMARK_TYPE_ERASURE_SOLUTION 1
+
+
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <numbers>
+#include <random>
+#include <span>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <variant>
+#include <vector>
+#if defined(__linux__)
+#  include <pthread.h>
+#  include <sched.h>
+#endif
+
+#if ( defined(__GNUC__) || defined(__clang__) ) && ( defined(__x86_64__) || defined(__i386__) )
+#  define KERNELS_AVX2 1
+#  include <immintrin.h>
+#else
+#  define KERNELS_AVX2 0
+#endif
+
+
+//---- Configuration ------------------------------------------------------------------------------
+
+constexpr size_t N( 20000UL );  // Number of shapes
+constexpr size_t width( 1920UL );  // Width of the framebuffer
+constexpr size_t height( 1080UL );  // Height of the framebuffer
+constexpr size_t tile_size( 64UL );  // Width and height of a tile
+constexpr size_t frames( 50UL );  // Number of rendered frames
+
+
+//---- <Vector2D.h> -------------------------------------------------------------------------------
+
+struct Vector2D
+{
+   double x{};
+   double y{};
+};
+
+
+//---- <Shapes.h> ---------------------------------------------------------------------------------
+
+//#include <Vector2D.h>
+
+// The six shapes of 'Strategy_Benchmark.cpp'. Pentagons and hexagons are regular polygons.
+
+struct Circle    { double radius{};  Vector2D center{}; };
+struct Ellipse   { double radius1{}; double radius2{}; Vector2D center{}; };
+struct Square    { double side{};    Vector2D center{}; };
+struct Rectangle { double width{};   double height{}; Vector2D center{}; };
+struct Pentagon  { double side{};    Vector2D center{}; };
+struct Hexagon   { double side{};    Vector2D center{}; };
+
+
+//---- <Primitive.h> ------------------------------------------------------------------------------
+
+//#include <Vector2D.h>
+
+// The description of a single shape for the rasterizer
+struct Primitive
+{
+   enum Kind : std::uint8_t { circle, ellipse, square, rectangle, pentagon, hexagon };
+
+   Kind kind{};
+   std::uint32_t color{};
+   Vector2D center{};
+   double a{};  // The (first) radius, half of the side or width, or the apothem of a polygon
+   double b{};  // The second radius or half of the height (otherwise the same as 'a')
+   Vector2D extent{};  // Half of the width and height of the bounding box
+};
+
+
+//---- <Canvas.h> ---------------------------------------------------------------------------------
+
+//#include <Primitive.h>
+//#include <Shapes.h>
+
+// The thin adapter between any shape representation and the rasterizer: A shape is "drawn" by
+// recording its primitive. Every representation only has to dispatch to the matching 'draw()'
+// overload.
+class Canvas
+{
+ public:
+   explicit Canvas( size_t capacity ) { primitives_.reserve( capacity ); }
+
+   void draw( Circle const& c )    { push( Primitive::circle, c.center, c.radius, c.radius, { c.radius, c.radius } ); }
+   void draw( Ellipse const& e )   { push( Primitive::ellipse, e.center, e.radius1, e.radius2, { e.radius1, e.radius2 } ); }
+   void draw( Square const& s )    { push( Primitive::square, s.center, 0.5*s.side, 0.5*s.side, { 0.5*s.side, 0.5*s.side } ); }
+   void draw( Rectangle const& r ) { push( Primitive::rectangle, r.center, 0.5*r.width, 0.5*r.height, { 0.5*r.width, 0.5*r.height } ); }
+   void draw( Pentagon const& p )  { polygon( Primitive::pentagon, p.center, p.side, 5.0 ); }
+   void draw( Hexagon const& h )   { polygon( Primitive::hexagon, h.center, h.side, 6.0 ); }
+
+   void clear() { primitives_.clear(); }
+
+   std::span<Primitive const> primitives() const { return primitives_; }
+
+ private:
+   void push( Primitive::Kind kind, Vector2D center, double a, double b, Vector2D extent )
+   {
+      static constexpr std::uint32_t palette[] = { 0xFF0000, 0x00FF00, 0x0000FF, 0xFFFF00, 0xFF00FF, 0x00FFFF };
+      primitives_.push_back( Primitive{ kind, palette[kind], center, a, b, extent } );
+   }
+
+   void polygon( Primitive::Kind kind, Vector2D center, double side, double n )
+   {
+      double const apothem( 0.5 * side / std::tan( std::numbers::pi / n ) );
+      double const circumradius( 0.5 * side / std::sin( std::numbers::pi / n ) );
+      push( kind, center, apothem, apothem, { circumradius, circumradius } );
+   }
+
+   std::vector<Primitive> primitives_;
+};
+
+
+//---- <Framebuffer.h> ----------------------------------------------------------------------------
+
+// A framebuffer in memory with one 32-bit pixel (0x00RRGGBB) per pixel, stored row by row
+class Framebuffer
+{
+ public:
+   Framebuffer( size_t width, size_t height )
+      : width_( width )
+      , height_( height )
+      , pixels_( width*height, background )
+   {}
+
+   size_t width() const { return width_; }
+   size_t height() const { return height_; }
+
+   std::uint32_t*       row( std::ptrdiff_t y )       { return pixels_.data() + y*static_cast<std::ptrdiff_t>(width_); }
+   std::uint32_t const* row( std::ptrdiff_t y ) const { return pixels_.data() + y*static_cast<std::ptrdiff_t>(width_); }
+
+   // An order-dependent hash of all pixels, which is identical only for identical images
+   std::uint64_t checksum() const
+   {
+      std::uint64_t hash( 14695981039346656037UL );
+      for( std::uint32_t p : pixels_ ) {
+         hash = ( hash ^ p ) * 1099511628211UL;
+      }
+      return hash;
+   }
+
+   static constexpr std::uint32_t background = 0xFF000000;
+
+ private:
+   size_t width_;
+   size_t height_;
+   std::vector<std::uint32_t> pixels_;
+};
+
+
+//---- <SpanFill.h> -------------------------------------------------------------------------------
+
+// Fills 'n' consecutive pixels with the given color
+struct ScalarFill
+{
+   void operator()( std::uint32_t* pixels, std::ptrdiff_t n, std::uint32_t color ) const
+   {
+      std::fill_n( pixels, n, color );
+   }
+};
+
+#if KERNELS_AVX2
+__attribute__((target("avx2")))
+void fill_avx2( std::uint32_t* pixels, std::ptrdiff_t n, std::uint32_t color )
+{
+   __m256i const c( _mm256_set1_epi32( static_cast<int>( color ) ) );
+
+   std::ptrdiff_t i( 0 );
+   for( ; i+8<=n; i+=8 ) {
+      _mm256_storeu_si256( reinterpret_cast<__m256i*>( pixels+i ), c );
+   }
+   for( ; i<n; ++i ) {
+      pixels[i] = color;
+   }
+}
+
+bool has_avx2()
+{
+   static bool const avx2( __builtin_cpu_supports( "avx2" ) );
+   return avx2;
+}
+
+struct Avx2Fill
+{
+   void operator()( std::uint32_t* pixels, std::ptrdiff_t n, std::uint32_t color ) const
+   {
+      fill_avx2( pixels, n, color );
+   }
+};
+#endif
+
+
+//---- <Rasterize.h> ------------------------------------------------------------------------------
+
+//#include <Framebuffer.h>
+//#include <Primitive.h>
+
+// A rectangular region [x0,x1) x [y0,y1) of the framebuffer
+struct Region
+{
+   std::ptrdiff_t x0, y0, x1, y1;
+};
+
+namespace detail {
+
+   // The first pixel whose center lies at or behind 'coordinate', clamped to [lower,upper]
+   inline std::ptrdiff_t first_pixel( double coordinate, std::ptrdiff_t lower, std::ptrdiff_t upper )
+   {
+      return static_cast<std::ptrdiff_t>( std::clamp( std::ceil( coordinate - 0.5 ),
+                                                      static_cast<double>( lower ),
+                                                      static_cast<double>( upper ) ) );
+   }
+
+   // Fills all pixels of the primitive within the region. 'half_span' computes, for the vertical
+   // distance 'dy' between the pixel center and the center of the primitive, the horizontal
+   // range of the primitive relative to its center (an empty range for 'left > right').
+   template< typename HalfSpan, typename Fill >
+   void fill_rows( Primitive const& p, Framebuffer& fb, Region const& region, Fill fill, HalfSpan half_span )
+   {
+      std::ptrdiff_t const y0( first_pixel( p.center.y - p.extent.y, region.y0, region.y1 ) );
+      std::ptrdiff_t const y1( first_pixel( p.center.y + p.extent.y, region.y0, region.y1 ) );
+
+      for( std::ptrdiff_t y=y0; y<y1; ++y )
+      {
+         auto const [left,right] = half_span( static_cast<double>(y) + 0.5 - p.center.y );
+         if( left > right ) continue;
+
+         std::ptrdiff_t const x0( first_pixel( p.center.x + left, region.x0, region.x1 ) );
+         std::ptrdiff_t const x1( first_pixel( p.center.x + right, region.x0, region.x1 ) );
+         if( x0 < x1 ) fill( fb.row(y) + x0, x1 - x0, p.color );
+      }
+   }
+
+   // The normals of the edges of a regular polygon with 'N' edges (with a horizontal top edge)
+   template< size_t N >
+   struct PolygonNormals
+   {
+      PolygonNormals()
+      {
+         for( size_t k=0UL; k<N; ++k ) {
+            double const angle( 0.5*std::numbers::pi + 2.0*std::numbers::pi*static_cast<double>(k)/N );
+            cos[k] = std::cos( angle );
+            sin[k] = std::sin( angle );
+         }
+      }
+
+      double cos[N];
+      double sin[N];
+   };
+
+   // The horizontal range of a regular polygon, i.e. the intersection of the half planes
+   // 'cos*dx + sin*dy <= apothem' of all edges
+   template< size_t N >
+   std::pair<double,double> polygon_span( double apothem, double dy )
+   {
+      static PolygonNormals<N> const normals{};
+
+      double left( -apothem / std::sin( std::numbers::pi / N ) );
+      double right( -left );
+
+      for( size_t k=0UL; k<N; ++k ) {
+         double const c( normals.cos[k] );
+         double const bound( apothem - normals.sin[k]*dy );
+         if( c > 1E-12 ) right = std::min( right, bound / c );
+         else if( c < -1E-12 ) left = std::max( left, bound / c );
+         else if( bound < 0.0 ) return { 1.0, -1.0 };
+      }
+
+      return { left, right };
+   }
+
+} // namespace detail
+
+// Rasterizes the given primitive into the given region of the framebuffer. A pixel is covered by
+// the primitive if its center lies within the primitive.
+template< typename Fill >
+void rasterize( Primitive const& p, Framebuffer& fb, Region const& region, Fill fill )
+{
+   using detail::fill_rows;
+
+   switch( p.kind )
+   {
+      case Primitive::circle:
+         fill_rows( p, fb, region, fill, [r=p.a]( double dy ){
+            double const d2( r*r - dy*dy );
+            double const h( d2 >= 0.0 ? std::sqrt( d2 ) : -1.0 );
+            return std::pair{ -h, h };
+         } );
+         break;
+
+      case Primitive::ellipse:
+         fill_rows( p, fb, region, fill, [a=p.a,b=p.b]( double dy ){
+            double const t( 1.0 - (dy/b)*(dy/b) );
+            double const h( t >= 0.0 ? a*std::sqrt( t ) : -1.0 );
+            return std::pair{ -h, h };
+         } );
+         break;
+
+      case Primitive::square:
+      case Primitive::rectangle:
+         fill_rows( p, fb, region, fill, [a=p.a]( double ){
+            return std::pair{ -a, a };
+         } );
+         break;
+
+      case Primitive::pentagon:
+         fill_rows( p, fb, region, fill, [a=p.a]( double dy ){
+            return detail::polygon_span<5UL>( a, dy );
+         } );
+         break;
+
+      case Primitive::hexagon:
+         fill_rows( p, fb, region, fill, [a=p.a]( double dy ){
+            return detail::polygon_span<6UL>( a, dy );
+         } );
+         break;
+   }
+}
+
+
+//---- Thread pool --------------------------------------------------------------------------------
+
+// A fixed set of threads, each pinned to one hardware thread (see 'ParallelMembers.cpp').
+// 'execute()' runs the given task on all threads and returns as soon as all threads are done.
+class Workers
+{
+ public:
+   explicit Workers( size_t n )
+      : sync_( static_cast<std::ptrdiff_t>( n+1UL ) )
+   {
+      threads_.reserve( n );
+      for( size_t t=0UL; t<n; ++t ) {
+         threads_.emplace_back( [this,t](){ run( t ); } );
+      }
+   }
+
+   ~Workers()
+   {
+      task_ = nullptr;
+      sync_.arrive_and_wait();
+   }
+
+   size_t size() const { return threads_.size(); }
+
+   void execute( std::function<void(size_t)> const& task )
+   {
+      task_ = &task;
+      sync_.arrive_and_wait();  // Start
+      sync_.arrive_and_wait();  // Finish
+   }
+
+ private:
+   void run( size_t t )
+   {
+      pin( t );
+      while( true ) {
+         sync_.arrive_and_wait();
+         if( !task_ ) return;
+         (*task_)( t );
+         sync_.arrive_and_wait();
+      }
+   }
+
+   static void pin( [[maybe_unused]] size_t t )
+   {
+#if defined(__linux__)
+      cpu_set_t set;
+      CPU_ZERO( &set );
+      CPU_SET( t % std::max( std::thread::hardware_concurrency(), 1U ), &set );
+      pthread_setaffinity_np( pthread_self(), sizeof(set), &set );
+#endif
+   }
+
+   std::function<void(size_t)> const* task_{};
+   std::barrier<> sync_;
+   std::vector<std::jthread> threads_;  // Declared last to be joined first
+};
+
+
+//---- <TiledRasterizer.h> ------------------------------------------------------------------------
+
+//#include <Rasterize.h>
+
+// Splits the framebuffer into square tiles. Every primitive is binned into all tiles that its
+// bounding box overlaps. Since the primitives of a tile keep their order, and since every tile
+// is rasterized by exactly one thread, the image is identical to the image of a sequential
+// rasterization, independent of the number of threads.
+class TiledRasterizer
+{
+ public:
+   TiledRasterizer( size_t width, size_t height, size_t tile_size )
+      : width_( width )
+      , height_( height )
+      , tile_size_( tile_size )
+      , tiles_x_( ( width + tile_size - 1UL ) / tile_size )
+      , tiles_y_( ( height + tile_size - 1UL ) / tile_size )
+      , bins_( tiles_x_*tiles_y_ )
+   {}
+
+   // Renders the primitives into the framebuffer. With 'workers == nullptr', all tiles are
+   // rendered by the calling thread, otherwise the threads take the tiles one by one.
+   template< typename Fill >
+   void render( std::span<Primitive const> primitives, Framebuffer& fb, Workers* workers, Fill fill )
+   {
+      bin( primitives );
+
+      if( !workers ) {
+         for( size_t tile=0UL; tile<bins_.size(); ++tile ) {
+            render_tile( tile, primitives, fb, fill );
+         }
+         return;
+      }
+
+      std::atomic<size_t> next{ 0UL };
+      std::function<void(size_t)> const task = [&]( size_t ){
+         for( size_t tile=next.fetch_add( 1UL, std::memory_order_relaxed ); tile<bins_.size();
+              tile=next.fetch_add( 1UL, std::memory_order_relaxed ) ) {
+            render_tile( tile, primitives, fb, fill );
+         }
+      };
+      workers->execute( task );
+   }
+
+ private:
+   void bin( std::span<Primitive const> primitives )
+   {
+      for( auto& bin : bins_ ) bin.clear();
+
+      auto const tile_index = [this]( double coordinate, size_t tiles ){
+         double const t( std::floor( coordinate / static_cast<double>( tile_size_ ) ) );
+         return static_cast<size_t>( std::clamp( t, 0.0, static_cast<double>( tiles-1UL ) ) );
+      };
+
+      for( size_t i=0UL; i<primitives.size(); ++i )
+      {
+         Primitive const& p( primitives[i] );
+         if( p.center.x + p.extent.x < 0.0 || p.center.x - p.extent.x > static_cast<double>( width_ ) ||
+             p.center.y + p.extent.y < 0.0 || p.center.y - p.extent.y > static_cast<double>( height_ ) ) continue;
+
+         size_t const tx0( tile_index( p.center.x - p.extent.x, tiles_x_ ) );
+         size_t const tx1( tile_index( p.center.x + p.extent.x, tiles_x_ ) );
+         size_t const ty0( tile_index( p.center.y - p.extent.y, tiles_y_ ) );
+         size_t const ty1( tile_index( p.center.y + p.extent.y, tiles_y_ ) );
+
+         for( size_t ty=ty0; ty<=ty1; ++ty ) {
+            for( size_t tx=tx0; tx<=tx1; ++tx ) {
+               bins_[ty*tiles_x_+tx].push_back( static_cast<std::uint32_t>( i ) );
+            }
+         }
+      }
+   }
+
+   // Clears the tile and rasterizes all primitives of the tile
+   template< typename Fill >
+   void render_tile( size_t tile, std::span<Primitive const> primitives, Framebuffer& fb, Fill fill ) const
+   {
+      auto const ts( static_cast<std::ptrdiff_t>( tile_size_ ) );
+      std::ptrdiff_t const tx( static_cast<std::ptrdiff_t>( tile % tiles_x_ ) );
+      std::ptrdiff_t const ty( static_cast<std::ptrdiff_t>( tile / tiles_x_ ) );
+
+      Region const region{ tx*ts, ty*ts
+                         , std::min( (tx+1)*ts, static_cast<std::ptrdiff_t>( width_ ) )
+                         , std::min( (ty+1)*ts, static_cast<std::ptrdiff_t>( height_ ) ) };
+
+      for( std::ptrdiff_t y=region.y0; y<region.y1; ++y ) {
+         fill( fb.row(y) + region.x0, region.x1 - region.x0, Framebuffer::background );
+      }
+
+      for( std::uint32_t i : bins_[tile] ) {
+         rasterize( primitives[i], fb, region, fill );
+      }
+   }
+
+   size_t width_;
+   size_t height_;
+   size_t tile_size_;
+   size_t tiles_x_;
+   size_t tiles_y_;
+   std::vector< std::vector<std::uint32_t> > bins_;
+};
+
+
+//---- Shape representations ----------------------------------------------------------------------
+
+#if BENCHMARK_EXTERNAL_POLYMORPHISM_SOLUTION
+namespace external_polymorphism_solution {
+
+   class ShapeConcept
+   {
+    public:
+      virtual ~ShapeConcept() = default;
+      virtual void draw( Canvas& canvas ) const = 0;
+   };
+
+   template< typename ShapeT >
+   class ShapeModel final : public ShapeConcept
+   {
+    public:
+      explicit ShapeModel( ShapeT shape ) : shape_( shape ) {}
+
+      void draw( Canvas& canvas ) const override { canvas.draw( shape_ ); }
+
+    private:
+      ShapeT shape_;
+   };
+
+   class Scene
+   {
+    public:
+      template< typename ShapeT >
+      void add( ShapeT const& shape ) { shapes_.push_back( std::make_unique<ShapeModel<ShapeT>>( shape ) ); }
+
+      void draw( Canvas& canvas ) const
+      {
+         for( auto const& shape : shapes_ ) {
+            shape->draw( canvas );
+         }
+      }
+
+    private:
+      std::vector< std::unique_ptr<ShapeConcept> > shapes_;
+   };
+
+} // namespace external_polymorphism_solution
+#endif
+
+
+#if BENCHMARK_VARIANT_SOLUTION
+namespace variant_solution {
+
+   using Shape = std::variant<Circle,Ellipse,Square,Rectangle,Pentagon,Hexagon>;
+
+   class Scene
+   {
+    public:
+      template< typename ShapeT >
+      void add( ShapeT const& shape ) { shapes_.emplace_back( shape ); }
+
+      void draw( Canvas& canvas ) const
+      {
+         for( auto const& shape : shapes_ ) {
+            std::visit( [&canvas]( auto const& s ){ canvas.draw( s ); }, shape );
+         }
+      }
+
+    private:
+      std::vector<Shape> shapes_;
+   };
+
+} // namespace variant_solution
+#endif
+
+
+#if BENCHMARK_TYPE_ERASURE_SOLUTION
+namespace type_erasure_solution {
+
+   class Shape
+   {
+    public:
+      template< typename ShapeT >
+      Shape( ShapeT const& shape )
+         : pimpl_( std::make_unique<Model<ShapeT>>( shape ) )
+      {}
+
+      Shape( Shape const& other ) : pimpl_( other.pimpl_->clone() ) {}
+      Shape& operator=( Shape const& other ) { Shape tmp( other ); std::swap( pimpl_, tmp.pimpl_ ); return *this; }
+      ~Shape() = default;
+      Shape( Shape&& ) = default;
+      Shape& operator=( Shape&& ) = default;
+
+    private:
+      friend void draw( Shape const& shape, Canvas& canvas )
+      {
+         shape.pimpl_->draw( canvas );
+      }
+
+      struct Concept
+      {
+         virtual ~Concept() = default;
+         virtual void draw( Canvas& canvas ) const = 0;
+         virtual std::unique_ptr<Concept> clone() const = 0;
+      };
+
+      template< typename ShapeT >
+      struct Model final : public Concept
+      {
+         explicit Model( ShapeT const& shape ) : shape_( shape ) {}
+
+         void draw( Canvas& canvas ) const override { canvas.draw( shape_ ); }
+         std::unique_ptr<Concept> clone() const override { return std::make_unique<Model>( *this ); }
+
+         ShapeT shape_;
+      };
+
+      std::unique_ptr<Concept> pimpl_;
+   };
+
+   void draw( Shape const& shape, Canvas& canvas );  // Makes the hidden friend visible in 'Scene'
+
+   class Scene
+   {
+    public:
+      template< typename ShapeT >
+      void add( ShapeT const& shape ) { shapes_.emplace_back( shape ); }
+
+      void draw( Canvas& canvas ) const
+      {
+         for( auto const& shape : shapes_ ) {
+            type_erasure_solution::draw( shape, canvas );
+         }
+      }
+
+    private:
+      std::vector<Shape> shapes_;
+   };
+
+} // namespace type_erasure_solution
+#endif
+
+
+//---- Benchmark ----------------------------------------------------------------------------------
+
+// Creates 'N' random shapes of all six kinds and passes each one to the given function
+template< typename Function >
+void generate_shapes( unsigned int seed, Function function )
+{
+   std::mt19937 rng{ seed };
+   std::uniform_int_distribution<int> kind( 0, 5 );
+   std::uniform_real_distribution<double> size( 2.0, 30.0 );
+   std::uniform_real_distribution<double> x( 0.0, static_cast<double>( width ) );
+   std::uniform_real_distribution<double> y( 0.0, static_cast<double>( height ) );
+
+   for( size_t i=0UL; i<N; ++i )
+   {
+      double const s1( size(rng) );
+      double const s2( size(rng) );
+      Vector2D const center{ x(rng), y(rng) };
+
+      switch( kind(rng) ) {
+         case 0: function( Circle{ s1, center } ); break;
+         case 1: function( Ellipse{ s1, s2, center } ); break;
+         case 2: function( Square{ s1, center } ); break;
+         case 3: function( Rectangle{ s1, s2, center } ); break;
+         case 4: function( Pentagon{ s1, center } ); break;
+         default: function( Hexagon{ s1, center } ); break;
+      }
+   }
+}
+
+
+// Creates 'N' random shapes of all six kinds in the given representation
+template< typename Scene >
+Scene generate_scene( unsigned int seed )
+{
+   Scene scene;
+   generate_shapes( seed, [&]( auto const& shape ){ scene.add( shape ); } );
+   return scene;
+}
+
+
+template< typename Function >
+double measure( Function function )
+{
+   std::chrono::time_point<std::chrono::high_resolution_clock> start, end;
+   start = std::chrono::high_resolution_clock::now();
+
+   for( size_t frame=0UL; frame<frames; ++frame ) {
+      function();
+   }
+
+   end = std::chrono::high_resolution_clock::now();
+   std::chrono::duration<double> const elapsedTime( end - start );
+   return elapsedTime.count() / frames;
+}
+
+
+void report( char const* label, double seconds, std::uint64_t checksum )
+{
+   // The formatting flags are set on a local stream to leave 'std::cout' unchanged
+   std::ostringstream os;
+   os << " " << std::left << std::setw(36) << label << ": " << std::right
+      << std::setw(8) << std::setprecision(4) << seconds*1E3 << " ms/frame"
+      << "  (checksum = " << std::hex << checksum << std::dec << ")\n";
+   std::cout << os.str();
+}
+
+
+// Renders the primitives with all rasterizer configurations
+template< typename Fill >
+void benchmark_rasterizer( char const* fill_name, std::span<Primitive const> primitives,
+                           std::vector<size_t> const& threads, Fill fill )
+{
+   {
+      Framebuffer fb( width, height );
+      Region const all{ 0, 0, static_cast<std::ptrdiff_t>( width ), static_cast<std::ptrdiff_t>( height ) };
+
+      double const seconds = measure( [&](){
+         for( std::ptrdiff_t y=0; y<all.y1; ++y ) fill( fb.row(y), all.x1, Framebuffer::background );
+         for( auto const& p : primitives ) rasterize( p, fb, all, fill );
+      } );
+
+      report( ( std::string( fill_name ) + ", no tiles" ).c_str(), seconds, fb.checksum() );
+   }
+
+   TiledRasterizer rasterizer( width, height, tile_size );
+
+   for( size_t t : threads )
+   {
+      Framebuffer fb( width, height );
+      std::unique_ptr<Workers> workers( t > 0UL ? std::make_unique<Workers>( t ) : nullptr );
+
+      double const seconds = measure( [&](){
+         rasterizer.render( primitives, fb, workers.get(), fill );
+      } );
+
+      std::string const label( std::string( fill_name ) + ", tiled, "
+                             + ( t == 0UL ? std::string( "no threads" ) : std::to_string( t ) + " thread(s)" ) );
+      report( label.c_str(), seconds, fb.checksum() );
+   }
+}
+
+
+// Records all shapes of the given representation and renders them with the tiled rasterizer
+template< typename Scene, typename Fill >
+void benchmark_representation( char const* label, unsigned int seed, size_t threads, Fill fill )
+{
+   Scene const scene( generate_scene<Scene>( seed ) );
+
+   Canvas canvas( N );
+   Framebuffer fb( width, height );
+   TiledRasterizer rasterizer( width, height, tile_size );
+   Workers workers( threads );
+
+   double const seconds = measure( [&](){
+      canvas.clear();
+      scene.draw( canvas );
+      rasterizer.render( canvas.primitives(), fb, &workers, fill );
+   } );
+
+   report( label, seconds, fb.checksum() );
+}
+
+
+int main()
+{
+   std::random_device rd{};
+   unsigned int const seed( rd() );
+
+   std::vector<size_t> threads{ 0UL };
+   unsigned int const max_threads( std::max( std::thread::hardware_concurrency(), 1U ) );
+   for( size_t t=1UL; t<max_threads; t*=2UL ) {
+      threads.push_back( t );
+   }
+   threads.push_back( max_threads );
+
+   std::cout << "\n " << N << " shapes, " << width << "x" << height << " framebuffer, "
+             << tile_size << "x" << tile_size << " tiles\n";
+
+   // The same scene for all rasterizer configurations
+   Canvas canvas( N );
+   generate_shapes( seed, [&]( auto const& shape ){ canvas.draw( shape ); } );
+
+   std::cout << "\n Rasterization\n";
+   benchmark_rasterizer( "Scalar fill", canvas.primitives(), threads, ScalarFill{} );
+#if KERNELS_AVX2
+   if( has_avx2() ) {
+      benchmark_rasterizer( "AVX2 fill", canvas.primitives(), threads, Avx2Fill{} );
+   }
+#endif
+
+   std::cout << "\n Shape representations (tiled, " << max_threads << " thread(s))\n";
+
+   auto const representations = [&]( [[maybe_unused]] auto fill )
+   {
+#if BENCHMARK_EXTERNAL_POLYMORPHISM_SOLUTION
+      benchmark_representation<external_polymorphism_solution::Scene>( "External polymorphism", seed, max_threads, fill );
+#endif
+#if BENCHMARK_VARIANT_SOLUTION
+      benchmark_representation<variant_solution::Scene>( "std::variant", seed, max_threads, fill );
+#endif
+#if BENCHMARK_TYPE_ERASURE_SOLUTION
+      benchmark_representation<type_erasure_solution::Scene>( "Type erasure", seed, max_threads, fill );
+#endif
+   };
+
+#if KERNELS_AVX2
+   if( has_avx2() ) representations( Avx2Fill{} );
+   else
+#endif
+   representations( ScalarFill{} );
+
+   std::cout << std::endl;
+
+   return EXIT_SUCCESS;
+}
@@ -0,0 +1,237 @@
+/**************************************************************************************************
+*
+* \file VariantVisit_Benchmark.cpp
+* \brief C++ Training - Benchmark for the Visitation of Variants with Many Alternatives
+*
+* Copyright (C) 2015-2023 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#define BENCHMARK_STD_VISIT 1
+#define BENCHMARK_MPARK_VISIT 1
+#define BENCHMARK_JUMP_TABLE_VISIT 1
+
+
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+#include "mpark/variant.hpp"
+
+
+struct Vector2D
+{
+   double x{};
+   double y{};
+};
+
+Vector2D operator+( Vector2D const& a, Vector2D const& b )
+{
+   return Vector2D{ a.x+b.x, a.y+b.y };
+}
+
+
+//=================================================================================================
+//
+//  JUMP TABLE VISIT
+//
+//=================================================================================================
+
+// The switch based visitation of 'mpark::visit()' handles 32 alternatives per 'switch' and chains
+// another 'switch' for every further block of 32 alternatives. This 'visit()' function instead
+// resolves the active alternative of any 'mpark::variant' by a single computed jump into a table
+// of 'variant_size' entries, independent of the number of alternatives. For small variants the
+// inlined 'switch' is faster than the call through the table, therefore these are still
+// forwarded to 'mpark::visit()'.
+namespace jump_table_visit {
+
+   constexpr size_t threshold( 16UL );
+
+   template< typename Visitor, typename Variant, size_t I >
+   decltype(auto) dispatch( Visitor&& visitor, Variant&& v )
+   {
+      // Unchecked access to the active alternative: the index has already been resolved
+      return std::forward<Visitor>( visitor )(
+         mpark::detail::access::variant::get_alt<I>( std::forward<Variant>( v ) ).value );
+   }
+
+   template< typename Visitor, typename Variant, size_t... Is >
+   constexpr auto make_table( std::index_sequence<Is...> )
+   {
+      return std::array{ &dispatch<Visitor,Variant,Is>... };
+   }
+
+   template< typename Visitor, typename Variant >
+   decltype(auto) visit( Visitor&& visitor, Variant&& v )
+   {
+      using V = std::remove_cvref_t<Variant>;
+
+      constexpr size_t size( mpark::variant_size<V>::value );
+
+      if constexpr( size <= threshold ) {
+         return mpark::visit( std::forward<Visitor>( visitor ), std::forward<Variant>( v ) );
+      }
+      else {
+         static constexpr auto table(
+            make_table<Visitor&&,Variant&&>( std::make_index_sequence<size>{} ) );
+
+         if( v.valueless_by_exception() ) {
+            mpark::throw_bad_variant_access();
+         }
+
+         return table[v.index()]( std::forward<Visitor>( visitor ), std::forward<Variant>( v ) );
+      }
+   }
+
+} // namespace jump_table_visit
+
+
+//=================================================================================================
+//
+//  SHAPES
+//
+//=================================================================================================
+
+// A family of shapes with an arbitrary number of alternatives. The number of extents varies
+// with the index, which results in different data layouts for different alternatives.
+template< size_t I >
+struct Polygon
+{
+   std::array<double,1UL+I%4UL> extents{};
+   Vector2D center{};
+};
+
+
+template< template< typename... > class VariantT, size_t... Is >
+VariantT< Polygon<Is>... > make_shape_type( std::index_sequence<Is...> );
+
+template< template< typename... > class VariantT, size_t N >
+using ShapeT = decltype( make_shape_type<VariantT>( std::make_index_sequence<N>{} ) );
+
+
+struct Translate
+{
+   template< size_t I >
+   void operator()( Polygon<I>& p ) const { p.center = p.center + v; }
+
+   Vector2D v{};
+};
+
+
+template< typename Shape, size_t... Is >
+Shape create_shape( size_t index, double extent, std::index_sequence<Is...> )
+{
+   Shape shape{};
+   ( ( index == Is ? void( shape = Polygon<Is>{ { extent }, {} } ) : void() ), ... );
+   return shape;
+}
+
+
+constexpr size_t N    ( 10000UL );
+constexpr size_t steps( 5000UL );
+
+
+template< typename Shape, size_t Alternatives, typename Visit >
+double benchmark( unsigned int seed, Visit visit )
+{
+   std::mt19937 rng{ seed };
+   std::uniform_int_distribution<size_t> index_dist( 0UL, Alternatives-1UL );
+   std::uniform_real_distribution<double> real_dist( 0.0, 1.0 );
+
+   std::vector<Shape> shapes;
+   shapes.reserve( N );
+
+   while( shapes.size() < N ) {
+      shapes.emplace_back( create_shape<Shape>( index_dist(rng), real_dist(rng)
+                                              , std::make_index_sequence<Alternatives>{} ) );
+   }
+
+   std::chrono::time_point<std::chrono::high_resolution_clock> start, end;
+   start = std::chrono::high_resolution_clock::now();
+
+   for( size_t s=0UL; s<steps; ++s ) {
+      Translate const translate{ Vector2D{ real_dist(rng), real_dist(rng) } };
+      for( auto& shape : shapes ) {
+         visit( translate, shape );
+      }
+   }
+
+   end = std::chrono::high_resolution_clock::now();
+   std::chrono::duration<double> const elapsedTime( end - start );
+   return elapsedTime.count();
+}
+
+
+template< size_t Alternatives >
+void benchmark( unsigned int seed )
+{
+   std::cout << " " << std::setw(12) << Alternatives;
+
+#if BENCHMARK_STD_VISIT
+   {
+      using Shape = ShapeT<std::variant,Alternatives>;
+      double const seconds( benchmark<Shape,Alternatives>( seed,
+         []( Translate const& t, Shape& s ){ std::visit( t, s ); } ) );
+      std::cout << std::setw(15) << seconds << "s";
+   }
+#endif
+
+#if BENCHMARK_MPARK_VISIT
+   {
+      using Shape = ShapeT<mpark::variant,Alternatives>;
+      double const seconds( benchmark<Shape,Alternatives>( seed,
+         []( Translate const& t, Shape& s ){ mpark::visit( t, s ); } ) );
+      std::cout << std::setw(15) << seconds << "s";
+   }
+#endif
+
+#if BENCHMARK_JUMP_TABLE_VISIT
+   {
+      using Shape = ShapeT<mpark::variant,Alternatives>;
+      double const seconds( benchmark<Shape,Alternatives>( seed,
+         []( Translate const& t, Shape& s ){ jump_table_visit::visit( t, s ); } ) );
+      std::cout << std::setw(15) << seconds << "s";
+   }
+#endif
+
+   std::cout << "\n";
+}
+
+
+int main()
+{
+   std::random_device rd{};
+   unsigned int const seed( rd() );
+
+   std::cout << "\n Alternatives"
+#if BENCHMARK_STD_VISIT
+             << "      std::visit"
+#endif
+#if BENCHMARK_MPARK_VISIT
+             << "    mpark::visit"
+#endif
+#if BENCHMARK_JUMP_TABLE_VISIT
+             << "      jump table"
+#endif
+             << "\n";
+
+   benchmark<6>( seed );
+   benchmark<12>( seed );
+   benchmark<20>( seed );
+   benchmark<32>( seed );
+   benchmark<40>( seed );
+   benchmark<64>( seed );
+
+   std::cout << std::endl;
+
+   return EXIT_SUCCESS;
+}
@@ -14,8 +14,11 @@
 #define BENCHMARK_OO_SOLUTION 1
 #define BENCHMARK_CYCLIC_VISITOR_SOLUTION 1
 #define BENCHMARK_ACYCLIC_VISITOR_SOLUTION 0
+#define BENCHMARK_ACYCLIC_INDEXED_VISITOR_SOLUTION 1
 #define BENCHMARK_STD_VARIANT_SOLUTION 1
 #define BENCHMARK_MPARK_VARIANT_SOLUTION 1
+#define BENCHMARK_VARIANT_VECTOR_SOLUTION 1
+#define BENCHMARK_COMPACT_VARIANT_SOLUTION 1
 #define BENCHMARK_BOOST_VARIANT_SOLUTION 0
 
 
@@ -29,12 +32,21 @@
 #define BENCHMARK_MANUAL_VISIT 0
 
 
+#include <algorithm>
+#include <array>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <cstdlib>
 #include <iomanip>
 #include <iostream>
+#include <iterator>
 #include <memory>
+#include <new>
 #include <random>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <variant>
 #include <vector>
 #if BENCHMARK_MPARK_VARIANT_SOLUTION
@@ -806,6 +818,276 @@ namespace acyclic_visitor_solution {
 #endif
 
 
+#if BENCHMARK_ACYCLIC_INDEXED_VISITOR_SOLUTION
+namespace acyclic_indexed_visitor_solution {
+
+#if BENCHMARK_WITH_CIRCLE
+   struct Circle;
+#endif
+#if BENCHMARK_WITH_ELLIPSE
+   struct Ellipse;
+#endif
+#if BENCHMARK_WITH_SQUARE
+   struct Square;
+#endif
+#if BENCHMARK_WITH_RECTANGLE
+   struct Rectangle;
+#endif
+#if BENCHMARK_WITH_PENTAGON
+   struct Pentagon;
+#endif
+#if BENCHMARK_WITH_HEXAGON
+   struct Hexagon;
+#endif
+
+
+   // Every visitable type is assigned a dense index on first use. This index is all a shape
+   // needs to know about the visitation, i.e. shapes still don't depend on any visitor.
+   inline size_t next_type_index()
+   {
+      static size_t counter{};
+      return counter++;
+   }
+
+   template< typename T >
+   size_t type_index()
+   {
+      static size_t const index{ next_type_index() };
+      return index;
+   }
+
+
+   struct Shape;
+
+   struct AbstractVisitor
+   {
+      using Thunk = void (*)( AbstractVisitor const&, Shape& );
+      using DispatchTable = std::vector<Thunk>;
+
+      explicit AbstractVisitor( DispatchTable const& t )
+         : table{ &t }
+      {}
+
+      virtual ~AbstractVisitor() = default;
+
+      // Replaces the 'dynamic_cast' of the classic acyclic visitor: a bounds check and a single
+      // indirect call through the table of the concrete visitor. Shapes unknown to the visitor
+      // are either out of bounds or map to 'ignore()', which mirrors a failing 'dynamic_cast'.
+      void dispatch( size_t index, Shape& shape ) const
+      {
+         if( index < table->size() ) {
+            (*table)[index]( *this, shape );
+         }
+      }
+
+      static void ignore( AbstractVisitor const&, Shape& ) {}
+
+      DispatchTable const* table{};
+   };
+
+
+   struct Shape
+   {
+      virtual ~Shape() {}
+      virtual void accept( AbstractVisitor const& v ) = 0;
+   };
+
+
+   template< typename T >
+   struct Visitor
+   {
+      virtual ~Visitor() = default;
+      virtual void visit( T& ) const = 0;
+   };
+
+
+   // The dispatch table is built once per concrete visitor type. Each entry statically casts
+   // back to the concrete visitor and calls its 'visit()' function non-virtually.
+   template< typename Derived, typename... Ts >
+   struct IndexedVisitor : public AbstractVisitor
+                         , public Visitor<Ts>...
+   {
+      IndexedVisitor()
+         : AbstractVisitor{ table() }
+      {}
+
+      static DispatchTable const& table()
+      {
+         static DispatchTable const t = []()
+         {
+            size_t size{};
+            ( ( size = std::max( size, type_index<Ts>()+1UL ) ), ... );
+
+            DispatchTable t( size, &AbstractVisitor::ignore );
+            ( ( t[type_index<Ts>()] = &thunk<Ts> ), ... );
+            return t;
+         }();
+
+         return t;
+      }
+
+      template< typename T >
+      static void thunk( AbstractVisitor const& v, Shape& s )
+      {
+         static_cast<Derived const&>( v ).Derived::visit( static_cast<T&>( s ) );
+      }
+   };
+
+
+#if BENCHMARK_WITH_CIRCLE
+   struct Circle : public Shape
+   {
+      explicit Circle( double r )
+         : radius{ r }
+      {}
+
+      void accept( AbstractVisitor const& v ) override { v.dispatch( type_index<Circle>(), *this ); }
+
+      double radius{};
+      Vector2D center{};
+   };
+#endif
+
+
+#if BENCHMARK_WITH_ELLIPSE
+   struct Ellipse : public Shape
+   {
+      Ellipse( double r1, double r2 )
+         : radius1{ r1 }
+         , radius2{ r2 }
+      {}
+
+      void accept( AbstractVisitor const& v ) override { v.dispatch( type_index<Ellipse>(), *this ); }
+
+      double radius1{};
+      double radius2{};
+      Vector2D center{};
+   };
+#endif
+
+
+#if BENCHMARK_WITH_SQUARE
+   struct Square : public Shape
+   {
+      explicit Square( double s )
+         : side{ s }
+      {}
+
+      void accept( AbstractVisitor const& v ) override { v.dispatch( type_index<Square>(), *this ); }
+
+      double side{};
+      Vector2D center{};
+   };
+#endif
+
+
+#if BENCHMARK_WITH_RECTANGLE
+   struct Rectangle : public Shape
+   {
+      Rectangle( double w, double h )
+         : width{ w }
+         , height{ h }
+      {}
+
+      void accept( AbstractVisitor const& v ) override { v.dispatch( type_index<Rectangle>(), *this ); }
+
+      double width{};
+      double height{};
+      Vector2D center{};
+   };
+#endif
+
+
+#if BENCHMARK_WITH_PENTAGON
+   struct Pentagon : public Shape
+   {
+      explicit Pentagon( double s )
+         : side{ s }
+      {}
+
+      void accept( AbstractVisitor const& v ) override { v.dispatch( type_index<Pentagon>(), *this ); }
+
+      double side{};
+      Vector2D center{};
+   };
+#endif
+
+
+#if BENCHMARK_WITH_HEXAGON
+   struct Hexagon : public Shape
+   {
+      explicit Hexagon( double s )
+         : side{ s }
+      {}
+
+      void accept( AbstractVisitor const& v ) override { v.dispatch( type_index<Hexagon>(), *this ); }
+
+      double side{};
+      Vector2D center{};
+   };
+#endif
+
+
+   struct Translate final : public IndexedVisitor< Translate
+#if BENCHMARK_WITH_CIRCLE
+                                                 , Circle
+#endif
+#if BENCHMARK_WITH_ELLIPSE
+                                                 , Ellipse
+#endif
+#if BENCHMARK_WITH_SQUARE
+                                                 , Square
+#endif
+#if BENCHMARK_WITH_RECTANGLE
+                                                 , Rectangle
+#endif
+#if BENCHMARK_WITH_PENTAGON
+                                                 , Pentagon
+#endif
+#if BENCHMARK_WITH_HEXAGON
+                                                 , Hexagon
+#endif
+                                                 >
+   {
+      Translate( Vector2D const& vec ) : v{ vec } {}
+#if BENCHMARK_WITH_CIRCLE
+      void visit( Circle& c ) const override { c.center = c.center + v; }
+#endif
+#if BENCHMARK_WITH_ELLIPSE
+      void visit( Ellipse& e ) const override { e.center = e.center + v; }
+#endif
+#if BENCHMARK_WITH_SQUARE
+      void visit( Square& s ) const override { s.center = s.center + v; }
+#endif
+#if BENCHMARK_WITH_RECTANGLE
+      void visit( Rectangle& r ) const override { r.center = r.center + v; }
+#endif
+#if BENCHMARK_WITH_PENTAGON
+      void visit( Pentagon& p ) const override { p.center = p.center + v; }
+#endif
+#if BENCHMARK_WITH_HEXAGON
+      void visit( Hexagon& h ) const override { h.center = h.center + v; }
+#endif
+      Vector2D v{};
+   };
+
+
+   using Shapes = std::vector< std::unique_ptr<Shape> >;
+
+   void translate( Shapes const& shapes, Vector2D const& v )
+   {
+      Translate const visitor{ v };
+
+      for( auto const& shape : shapes )
+      {
+         shape->accept( visitor );
+      }
+   }
+
+} // namespace acyclic_indexed_visitor_solution
+#endif
+
+
 #if BENCHMARK_STD_VARIANT_SOLUTION
 namespace std_variant_solution {
 
@@ -1038,7 +1320,699 @@ namespace mpark_variant_solution {
 #endif
 
 
-   using Shape = mpark::variant<
+   using Shape = mpark::variant<
+#if BENCHMARK_WITH_CIRCLE
+      Circle
+#endif
+#if BENCHMARK_WITH_CIRCLE && BENCHMARK_WITH_ELLIPSE
+      ,Ellipse
+#elif BENCHMARK_WITH_ELLIPSE
+      Ellipse
+#endif
+#if ( BENCHMARK_WITH_CIRCLE || BENCHMARK_WITH_ELLIPSE ) && BENCHMARK_WITH_SQUARE
+      ,Square
+#elif BENCHMARK_WITH_SQUARE
+      Square
+#endif
+#if ( BENCHMARK_WITH_CIRCLE || BENCHMARK_WITH_ELLIPSE || BENCHMARK_WITH_SQUARE ) && BENCHMARK_WITH_RECTANGLE
+      ,Rectangle
+#elif BENCHMARK_WITH_RECTANGLE
+      Rectangle
+#endif
+#if ( BENCHMARK_WITH_CIRCLE || BENCHMARK_WITH_ELLIPSE || BENCHMARK_WITH_SQUARE || BENCHMARK_WITH_RECTANGLE ) && BENCHMARK_WITH_PENTAGON
+      ,Pentagon
+#elif BENCHMARK_WITH_PENTAGON
+      Pentagon
+#endif
+#if ( BENCHMARK_WITH_CIRCLE || BENCHMARK_WITH_ELLIPSE || BENCHMARK_WITH_SQUARE || BENCHMARK_WITH_RECTANGLE || BENCHMARK_WITH_PENTAGON ) && BENCHMARK_WITH_HEXAGON
+      ,Hexagon
+#elif BENCHMARK_WITH_HEXAGON
+      Hexagon
+#endif
+      >;
+
+
+   struct Translate
+   {
+#if BENCHMARK_WITH_CIRCLE
+      void operator()( Circle& c ) const { c.center = c.center + v; }
+#endif
+#if BENCHMARK_WITH_ELLIPSE
+      void operator()( Ellipse& e ) const { e.center = e.center + v; }
+#endif
+#if BENCHMARK_WITH_SQUARE
+      void operator()( Square& s ) const { s.center = s.center + v; }
+#endif
+#if BENCHMARK_WITH_RECTANGLE
+      void operator()( Rectangle& r ) const { r.center = r.center + v; }
+#endif
+#if BENCHMARK_WITH_PENTAGON
+      void operator()( Pentagon& p ) const { p.center = p.center + v; }
+#endif
+#if BENCHMARK_WITH_HEXAGON
+      void operator()( Hexagon& h ) const { h.center = h.center + v; }
+#endif
+      Vector2D v{};
+   };
+
+   void translate( Shape& s, Vector2D const& v )
+   {
+#if BENCHMARK_MANUAL_VISIT
+#if   BENCHMARK_WITH_CIRCLE
+      if( Circle* circle = mpark::get_if<Circle>(&s) ) {
+         circle->center = circle->center + v;
+         return;
+      }
+#  endif
+#  if BENCHMARK_WITH_ELLIPSE
+      if( Ellipse* ellipse = mpark::get_if<Ellipse>(&s) ) {
+         ellipse->center = ellipse->center + v;
+         return;
+      }
+#  endif
+#  if BENCHMARK_WITH_SQUARE
+      if( Square* square = mpark::get_if<Square>(&s) ) {
+         square->center = square->center + v;
+         return;
+      }
+#  endif
+#  if BENCHMARK_WITH_RECTANGLE
+      if( Rectangle* rectangle = mpark::get_if<Rectangle>(&s) ) {
+         rectangle->center = rectangle->center + v;
+         return;
+      }
+#  endif
+#  if BENCHMARK_WITH_PENTAGON
+      if( Pentagon* pentagon = mpark::get_if<Pentagon>(&s) ) {
+         pentagon->center = pentagon->center + v;
+         return;
+      }
+#  endif
+#  if BENCHMARK_WITH_HEXAGON
+      if( Hexagon* hexagon = mpark::get_if<Hexagon>(&s) ) {
+         hexagon->center = hexagon->center + v;
+         return;
+      }
+#  endif
+#endif
+
+      mpark::visit( Translate{ v }, s );
+   }
+
+
+   using Shapes = std::vector<Shape>;
+
+   void translate( Shapes& shapes, Vector2D const& v )
+   {
+      for( auto& shape : shapes )
+      {
+         translate( shape, v );
+      }
+   }
+
+} // namespace mpark_variant_solution
+#endif
+
+
+#if BENCHMARK_VARIANT_VECTOR_SOLUTION
+namespace variant_vector_solution {
+
+   // A sequence of elements of the types 'Ts...', which stores the elements of every type in a
+   // separate, dense vector. In contrast to 'std::vector<std::variant<Ts...>>' no element is
+   // padded to the size of the largest alternative and 'visit_all()' runs one monomorphic loop
+   // per alternative instead of a visit per element. Optionally ('Ordered') an order index
+   // remembers the insertion order of all elements for 'visit_ordered()'. Both 'push_back()'
+   // and 'erase()' preserve the relative order of all remaining elements.
+   template< bool Ordered, typename... Ts >
+   class basic_variant_vector
+   {
+    public:
+      static constexpr size_t alternatives = sizeof...(Ts);
+
+      template< size_t I >
+      using alternative = std::tuple_element_t< I, std::tuple<Ts...> >;
+
+      template< typename T >
+      static constexpr size_t index_of()
+      {
+         constexpr bool matches[]{ std::is_same_v<T,Ts>... };
+
+         for( size_t i=0UL; i<alternatives; ++i ) {
+            if( matches[i] ) return i;
+         }
+         return alternatives;
+      }
+
+      size_t size() const { return size_; }
+      bool empty() const { return size_ == 0UL; }
+
+      template< typename T >
+      std::vector<T>& bucket() { return std::get<std::vector<T>>( buckets_ ); }
+
+      template< typename T >
+      std::vector<T> const& bucket() const { return std::get<std::vector<T>>( buckets_ ); }
+
+      template< typename T >
+      void push_back( T const& value )
+      {
+         static_assert( index_of<T>() < alternatives, "Invalid alternative" );
+
+         auto& b( bucket<T>() );
+         if constexpr( Ordered ) {
+            order_.push_back( Slot{ index_of<T>(), b.size() } );
+         }
+         b.push_back( value );
+         ++size_;
+      }
+
+      // Erases the element at position 'pos' within the bucket of type 'T'
+      template< typename T >
+      void erase( size_t pos )
+      {
+         static_assert( index_of<T>() < alternatives, "Invalid alternative" );
+
+         auto& b( bucket<T>() );
+         b.erase( b.begin() + pos );
+         --size_;
+
+         if constexpr( Ordered ) {
+            constexpr size_t type( index_of<T>() );
+            std::erase_if( order_, [pos]( Slot const& s ){ return s.type == type && s.index == pos; } );
+            for( Slot& s : order_ ) {
+               if( s.type == type && s.index > pos ) --s.index;
+            }
+         }
+      }
+
+      // Erases all elements for which 'pred' returns 'true'
+      template< typename Pred >
+      size_t erase_if( Pred pred )
+      {
+         size_t const old_size( size_ );
+         size_ = 0UL;
+
+         if constexpr( Ordered ) {
+            // 'pred' is evaluated exactly once per element. The resulting new positions are used
+            // to compact both the buckets and the order index.
+            std::array<std::vector<size_t>,alternatives> remap{};
+            for_each_bucket( [&]( auto& b, auto type ) {
+               auto& map( remap[type] );
+               map.resize( b.size() );
+               size_t next{};
+               for( size_t i=0UL; i<b.size(); ++i ) {
+                  map[i] = pred( b[i] ) ? npos : next++;
+               }
+               for( size_t i=0UL; i<b.size(); ++i ) {
+                  if( map[i] != npos && map[i] != i ) b[map[i]] = std::move( b[i] );
+               }
+               b.erase( b.begin() + next, b.end() );
+               size_ += next;
+            } );
+            std::erase_if( order_, [&remap]( Slot const& s ){ return remap[s.type][s.index] == npos; } );
+            for( Slot& s : order_ ) {
+               s.index = remap[s.type][s.index];
+            }
+         }
+         else {
+            for_each_bucket( [&]( auto& b, auto ) {
+               std::erase_if( b, [&pred]( auto const& e ){ return pred( e ); } );
+               size_ += b.size();
+            } );
+         }
+
+         return old_size - size_;
+      }
+
+      // Calls 'f' for all elements, bucket by bucket
+      template< typename F >
+      void visit_all( F&& f )
+      {
+         for_each_bucket( [&f]( auto& b, auto ) {
+            for( auto& e : b ) f( e );
+         } );
+      }
+
+      template< typename F >
+      void visit_all( F&& f ) const
+      {
+         for_each_bucket( [&f]( auto const& b, auto ) {
+            for( auto const& e : b ) f( e );
+         } );
+      }
+
+      // Calls 'f' for all elements in insertion order, which requires one dispatch per element
+      template< typename F >
+         requires Ordered
+      void visit_ordered( F&& f )
+      {
+         for( Slot const& s : order_ ) {
+            dispatch( s, f, std::make_index_sequence<alternatives>{} );
+         }
+      }
+
+    private:
+      static constexpr size_t npos = static_cast<size_t>( -1 );
+
+      struct Slot
+      {
+         size_t type{};
+         size_t index{};
+      };
+
+      template< typename F >
+      void for_each_bucket( F&& f )
+      {
+         for_each_bucket( f, std::make_index_sequence<alternatives>{} );
+      }
+
+      template< typename F >
+      void for_each_bucket( F&& f ) const
+      {
+         for_each_bucket( f, std::make_index_sequence<alternatives>{} );
+      }
+
+      template< typename F, size_t... Is >
+      void for_each_bucket( F& f, std::index_sequence<Is...> )
+      {
+         ( f( std::get<Is>( buckets_ ), std::integral_constant<size_t,Is>{} ), ... );
+      }
+
+      template< typename F, size_t... Is >
+      void for_each_bucket( F& f, std::index_sequence<Is...> ) const
+      {
+         ( f( std::get<Is>( buckets_ ), std::integral_constant<size_t,Is>{} ), ... );
+      }
+
+      template< typename F, size_t... Is >
+      void dispatch( Slot const& s, F& f, std::index_sequence<Is...> )
+      {
+         ( ( s.type == Is ? void( f( std::get<Is>( buckets_ )[s.index] ) ) : void() ), ... );
+      }
+
+      std::tuple< std::vector<Ts>... > buckets_;
+      std::vector<Slot> order_;
+      size_t size_{};
+   };
+
+   template< typename... Ts >
+   using variant_vector = basic_variant_vector<false,Ts...>;
+
+   template< typename... Ts >
+   using ordered_variant_vector = basic_variant_vector<true,Ts...>;
+
+
+#if BENCHMARK_WITH_CIRCLE
+   struct Circle
+   {
+      double radius{};
+      Vector2D center{};
+   };
+#endif
+
+
+#if BENCHMARK_WITH_ELLIPSE
+   struct Ellipse
+   {
+      double radius1{};
+      double radius2{};
+      Vector2D center{};
+   };
+#endif
+
+
+#if BENCHMARK_WITH_SQUARE
+   struct Square
+   {
+      double side{};
+      Vector2D center{};
+   };
+#endif
+
+
+#if BENCHMARK_WITH_RECTANGLE
+   struct Rectangle
+   {
+      double width{};
+      double height{};
+      Vector2D center{};
+   };
+#endif
+
+
+#if BENCHMARK_WITH_PENTAGON
+   struct Pentagon
+   {
+      double side{};
+      Vector2D center{};
+   };
+#endif
+
+
+#if BENCHMARK_WITH_HEXAGON
+   struct Hexagon
+   {
+      double side{};
+      Vector2D center{};
+   };
+#endif
+
+
+   struct Translate
+   {
+#if BENCHMARK_WITH_CIRCLE
+      void operator()( Circle& c ) const { c.center = c.center + v; }
+#endif
+#if BENCHMARK_WITH_ELLIPSE
+      void operator()( Ellipse& e ) const { e.center = e.center + v; }
+#endif
+#if BENCHMARK_WITH_SQUARE
+      void operator()( Square& s ) const { s.center = s.center + v; }
+#endif
+#if BENCHMARK_WITH_RECTANGLE
+      void operator()( Rectangle& r ) const { r.center = r.center + v; }
+#endif
+#if BENCHMARK_WITH_PENTAGON
+      void operator()( Pentagon& p ) const { p.center = p.center + v; }
+#endif
+#if BENCHMARK_WITH_HEXAGON
+      void operator()( Hexagon& h ) const { h.center = h.center + v; }
+#endif
+      Vector2D v{};
+   };
+
+
+   template< bool Ordered >
+   using BasicShapes = basic_variant_vector< Ordered
+#if BENCHMARK_WITH_CIRCLE
+      ,Circle
+#endif
+#if BENCHMARK_WITH_ELLIPSE
+      ,Ellipse
+#endif
+#if BENCHMARK_WITH_SQUARE
+      ,Square
+#endif
+#if BENCHMARK_WITH_RECTANGLE
+      ,Rectangle
+#endif
+#if BENCHMARK_WITH_PENTAGON
+      ,Pentagon
+#endif
+#if BENCHMARK_WITH_HEXAGON
+      ,Hexagon
+#endif
+      >;
+
+   using Shapes = BasicShapes<false>;
+   using OrderedShapes = BasicShapes<true>;
+
+   void translate( Shapes& shapes, Vector2D const& v )
+   {
+      shapes.visit_all( Translate{ v } );
+   }
+
+
+   // Exercises the order index of 'OrderedShapes': Every shape is tagged with its insertion
+   // index in 'center.x'. After a single 'erase()' and an 'erase_if()' with a stateful predicate,
+   // 'visit_ordered()' has to visit exactly the remaining shapes in ascending order.
+   template< size_t... Is >
+   void push_back( OrderedShapes& shapes, size_t type, Vector2D const& center, std::index_sequence<Is...> )
+   {
+      ( ( type == Is ? [&]{
+            typename OrderedShapes::template alternative<Is> shape{};
+            shape.center = center;
+            shapes.push_back( shape );
+         }() : void() ), ... );
+   }
+
+   bool check_ordered( size_t n, unsigned int seed )
+   {
+      std::mt19937 rng{ seed };
+      std::uniform_int_distribution<size_t> type_dist( 0UL, OrderedShapes::alternatives-1UL );
+
+      OrderedShapes shapes;
+      std::vector<size_t> expected;
+
+      for( size_t i=0UL; i<n; ++i ) {
+         push_back( shapes, type_dist(rng), Vector2D{ static_cast<double>( i ), 0.0 },
+                    std::make_index_sequence<OrderedShapes::alternatives>{} );
+         expected.push_back( i );
+      }
+
+      auto const tag = []( auto const& shape ){ return static_cast<size_t>( shape.center.x ); };
+      auto const drop = [&expected]( size_t id ){ std::erase( expected, id ); };
+
+      auto& first( shapes.bucket<OrderedShapes::alternative<0UL>>() );
+      if( !first.empty() ) {
+         drop( tag( first[first.size()/2UL] ) );
+         shapes.erase<OrderedShapes::alternative<0UL>>( first.size()/2UL );
+      }
+
+      size_t calls{};
+      size_t const erased = shapes.erase_if( [&]( auto const& shape ){
+         bool const remove( calls++ % 3UL == 0UL );
+         if( remove ) drop( tag( shape ) );
+         return remove;
+      } );
+
+      std::vector<size_t> visited;
+      shapes.visit_ordered( [&]( auto const& shape ){ visited.push_back( tag( shape ) ); } );
+
+      return calls == shapes.size() + erased
+          && shapes.size() == expected.size()
+          && visited == expected;
+   }
+
+} // namespace variant_vector_solution
+#endif
+
+
+#if BENCHMARK_COMPACT_VARIANT_SOLUTION
+namespace compact_variant_solution {
+
+   // A sequence of elements of the types 'Ts...', which stores every element with its exact size
+   // and alignment in a contiguous byte stream. The type tags are kept in a separate stream of
+   // one byte per element, i.e. in contrast to 'std::vector<std::variant<Ts...>>' no element is
+   // padded to the size of the largest alternative. Since elements are relocated bytewise, all
+   // types are required to be trivially copyable.
+   template< typename... Ts >
+   class compact_sequence
+   {
+    public:
+      static constexpr size_t alternatives = sizeof...(Ts);
+
+      static_assert( alternatives <= 256UL, "Too many alternatives for a one byte tag" );
+      static_assert( ( std::is_trivially_copyable_v<Ts> && ... ), "Non-trivially copyable alternative" );
+      static_assert( std::max( { alignof(Ts)... } ) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "Over-aligned alternative" );
+
+      template< typename T >
+      static constexpr size_t index_of()
+      {
+         constexpr bool matches[]{ std::is_same_v<T,Ts>... };
+
+         for( size_t i=0UL; i<alternatives; ++i ) {
+            if( matches[i] ) return i;
+         }
+         return alternatives;
+      }
+
+      // A reference to a single element in the byte stream
+      class element
+      {
+       public:
+         element( std::uint8_t tag, std::byte* data ) : tag_( tag ), data_( data ) {}
+
+         size_t index() const { return tag_; }
+
+         template< typename T >
+         T* get_if() const
+         {
+            return tag_ == index_of<T>() ? std::launder( reinterpret_cast<T*>( data_ ) ) : nullptr;
+         }
+
+         template< typename F >
+         void visit( F&& f ) const
+         {
+            visit( f, std::make_index_sequence<alternatives>{} );
+         }
+
+       private:
+         template< typename F, size_t... Is >
+         void visit( F& f, std::index_sequence<Is...> ) const
+         {
+            ( ( tag_ == Is ? void( f( *std::launder( reinterpret_cast<Ts*>( data_ ) ) ) ) : void() ), ... );
+         }
+
+         std::uint8_t tag_;
+         std::byte* data_;
+      };
+
+      class iterator
+      {
+       public:
+         using iterator_category = std::forward_iterator_tag;
+         using value_type        = element;
+         using difference_type   = std::ptrdiff_t;
+         using pointer           = void;
+         using reference         = element;
+
+         iterator() = default;
+         iterator( std::uint8_t const* tag, std::byte* base, size_t offset )
+            : tag_( tag ), base_( base ), offset_( offset )
+         {}
+
+         element operator*() const
+         {
+            return element{ *tag_, base_ + align( offset_, alignments[*tag_] ) };
+         }
+
+         iterator& operator++()
+         {
+            offset_ = align( offset_, alignments[*tag_] ) + sizes[*tag_];
+            ++tag_;
+            return *this;
+         }
+
+         iterator operator++( int ) { iterator tmp( *this ); ++(*this); return tmp; }
+
+         friend bool operator==( iterator const& a, iterator const& b ) { return a.tag_ == b.tag_; }
+
+       private:
+         std::uint8_t const* tag_{};
+         std::byte* base_{};
+         size_t offset_{};
+      };
+
+      size_t size() const { return tags_.size(); }
+      bool empty() const { return tags_.empty(); }
+
+      // The number of bytes occupied by the elements and their tags
+      size_t bytes() const { return tags_.size()*sizeof(std::uint8_t) + data_.size(); }
+
+      void reserve( size_t elements, size_t bytes )
+      {
+         tags_.reserve( elements );
+         data_.reserve( bytes );
+      }
+
+      template< typename T >
+      void push_back( T const& value )
+      {
+         static_assert( index_of<T>() < alternatives, "Invalid alternative" );
+
+         size_t const offset( align( data_.size(), alignof(T) ) );
+         data_.resize( offset + sizeof(T) );
+         ::new( data_.data() + offset ) T( value );
+         tags_.push_back( static_cast<std::uint8_t>( index_of<T>() ) );
+      }
+
+      iterator begin() { return iterator{ tags_.data(), data_.data(), 0UL }; }
+      iterator end() { return iterator{ tags_.data() + tags_.size(), data_.data(), data_.size() }; }
+
+      // Calls 'f' for all elements in place and in insertion order
+      template< typename F >
+      void visit_all( F&& f )
+      {
+         for( element e : *this ) {
+            e.visit( f );
+         }
+      }
+
+    private:
+      static constexpr size_t align( size_t offset, size_t alignment )
+      {
+         return ( offset + alignment - 1UL ) & ~( alignment - 1UL );
+      }
+
+      static constexpr std::array<size_t,alternatives> sizes{ sizeof(Ts)... };
+      static constexpr std::array<size_t,alternatives> alignments{ alignof(Ts)... };
+
+      std::vector<std::uint8_t> tags_;
+      std::vector<std::byte> data_;
+   };
+
+
+#if BENCHMARK_WITH_CIRCLE
+   struct Circle
+   {
+      double radius{};
+      Vector2D center{};
+   };
+#endif
+
+
+#if BENCHMARK_WITH_ELLIPSE
+   struct Ellipse
+   {
+      double radius1{};
+      double radius2{};
+      Vector2D center{};
+   };
+#endif
+
+
+#if BENCHMARK_WITH_SQUARE
+   struct Square
+   {
+      double side{};
+      Vector2D center{};
+   };
+#endif
+
+
+#if BENCHMARK_WITH_RECTANGLE
+   struct Rectangle
+   {
+      double width{};
+      double height{};
+      Vector2D center{};
+   };
+#endif
+
+
+#if BENCHMARK_WITH_PENTAGON
+   struct Pentagon
+   {
+      double side{};
+      Vector2D center{};
+   };
+#endif
+
+
+#if BENCHMARK_WITH_HEXAGON
+   struct Hexagon
+   {
+      double side{};
+      Vector2D center{};
+   };
+#endif
+
+
+   struct Translate
+   {
+#if BENCHMARK_WITH_CIRCLE
+      void operator()( Circle& c ) const { c.center = c.center + v; }
+#endif
+#if BENCHMARK_WITH_ELLIPSE
+      void operator()( Ellipse& e ) const { e.center = e.center + v; }
+#endif
+#if BENCHMARK_WITH_SQUARE
+      void operator()( Square& s ) const { s.center = s.center + v; }
+#endif
+#if BENCHMARK_WITH_RECTANGLE
+      void operator()( Rectangle& r ) const { r.center = r.center + v; }
+#endif
+#if BENCHMARK_WITH_PENTAGON
+      void operator()( Pentagon& p ) const { p.center = p.center + v; }
+#endif
+#if BENCHMARK_WITH_HEXAGON
+      void operator()( Hexagon& h ) const { h.center = h.center + v; }
+#endif
+      Vector2D v{};
+   };
+
+
+   using Shapes = compact_sequence<
 #if BENCHMARK_WITH_CIRCLE
       Circle
 #endif
@@ -1069,86 +2043,12 @@ namespace mpark_variant_solution {
 #endif
       >;
 
-
-   struct Translate
-   {
-#if BENCHMARK_WITH_CIRCLE
-      void operator()( Circle& c ) const { c.center = c.center + v; }
-#endif
-#if BENCHMARK_WITH_ELLIPSE
-      void operator()( Ellipse& e ) const { e.center = e.center + v; }
-#endif
-#if BENCHMARK_WITH_SQUARE
-      void operator()( Square& s ) const { s.center = s.center + v; }
-#endif
-#if BENCHMARK_WITH_RECTANGLE
-      void operator()( Rectangle& r ) const { r.center = r.center + v; }
-#endif
-#if BENCHMARK_WITH_PENTAGON
-      void operator()( Pentagon& p ) const { p.center = p.center + v; }
-#endif
-#if BENCHMARK_WITH_HEXAGON
-      void operator()( Hexagon& h ) const { h.center = h.center + v; }
-#endif
-      Vector2D v{};
-   };
-
-   void translate( Shape& s, Vector2D const& v )
-   {
-#if BENCHMARK_MANUAL_VISIT
-#if   BENCHMARK_WITH_CIRCLE
-      if( Circle* circle = mpark::get_if<Circle>(&s) ) {
-         circle->center = circle->center + v;
-         return;
-      }
-#  endif
-#  if BENCHMARK_WITH_ELLIPSE
-      if( Ellipse* ellipse = mpark::get_if<Ellipse>(&s) ) {
-         ellipse->center = ellipse->center + v;
-         return;
-      }
-#  endif
-#  if BENCHMARK_WITH_SQUARE
-      if( Square* square = mpark::get_if<Square>(&s) ) {
-         square->center = square->center + v;
-         return;
-      }
-#  endif
-#  if BENCHMARK_WITH_RECTANGLE
-      if( Rectangle* rectangle = mpark::get_if<Rectangle>(&s) ) {
-         rectangle->center = rectangle->center + v;
-         return;
-      }
-#  endif
-#  if BENCHMARK_WITH_PENTAGON
-      if( Pentagon* pentagon = mpark::get_if<Pentagon>(&s) ) {
-         pentagon->center = pentagon->center + v;
-         return;
-      }
-#  endif
-#  if BENCHMARK_WITH_HEXAGON
-      if( Hexagon* hexagon = mpark::get_if<Hexagon>(&s) ) {
-         hexagon->center = hexagon->center + v;
-         return;
-      }
-#  endif
-#endif
-
-      mpark::visit( Translate{ v }, s );
-   }
-
-
-   using Shapes = std::vector<Shape>;
-
    void translate( Shapes& shapes, Vector2D const& v )
    {
-      for( auto& shape : shapes )
-      {
-         translate( shape, v );
-      }
+      shapes.visit_all( Translate{ v } );
    }
 
-} // namespace mpark_variant_solution
+} // namespace compact_variant_solution
 #endif
 
 
@@ -1536,6 +2436,65 @@ int main()
    }
 #endif
 
+#if BENCHMARK_ACYCLIC_INDEXED_VISITOR_SOLUTION
+   {
+      using namespace acyclic_indexed_visitor_solution;
+
+      rng.seed( seed );
+
+      Shapes shapes;
+
+      while( shapes.size() < N )
+      {
+         int const random_value( int_dist(rng) );
+
+         if( random_value == 1 ) {
+#if BENCHMARK_WITH_CIRCLE
+            shapes.emplace_back( std::make_unique<Circle>( real_dist(rng) ) );
+#endif
+         }
+         else if( random_value == 2 ) {
+#if BENCHMARK_WITH_ELLIPSE
+            shapes.emplace_back( std::make_unique<Ellipse>( real_dist(rng), real_dist(rng) ) );
+#endif
+         }
+         else if( random_value == 3 ) {
+#if BENCHMARK_WITH_SQUARE
+            shapes.emplace_back( std::make_unique<Square>( real_dist(rng) ) );
+#endif
+         }
+         else if( random_value == 4 ) {
+#if BENCHMARK_WITH_RECTANGLE
+            shapes.emplace_back( std::make_unique<Rectangle>( real_dist(rng), real_dist(rng) ) );
+#endif
+         }
+         else if( random_value == 5 ) {
+#if BENCHMARK_WITH_PENTAGON
+            shapes.emplace_back( std::make_unique<Pentagon>( real_dist(rng) ) );
+#endif
+         }
+         else {
+#if BENCHMARK_WITH_HEXAGON
+            shapes.emplace_back( std::make_unique<Hexagon>( real_dist(rng) ) );
+#endif
+         }
+      }
+
+      std::chrono::time_point<std::chrono::high_resolution_clock> start, end;
+      start = std::chrono::high_resolution_clock::now();
+
+      for( size_t s=0UL; s<steps; ++s ) {
+         translate( shapes, Vector2D{ real_dist(rng), real_dist(rng) } );
+      }
+
+      end = std::chrono::high_resolution_clock::now();
+      std::chrono::duration<double> const elapsedTime( end - start );
+      double const seconds( elapsedTime.count() );
+
+      std::cout << " Indexed acyclic visitor runtime : " << seconds << "s\n";
+   }
+#endif
+
 #if BENCHMARK_STD_VARIANT_SOLUTION
    {
       using namespace std_variant_solution;
@@ -1654,6 +2613,168 @@ int main()
    }
 #endif
 
+#if BENCHMARK_VARIANT_VECTOR_SOLUTION
+   {
+      using namespace variant_vector_solution;
+
+      rng.seed( seed );
+
+      Shapes shapes;
+
+      while( shapes.size() < N )
+      {
+         int const random_value( int_dist(rng) );
+
+         if( random_value == 1 ) {
+#if BENCHMARK_WITH_CIRCLE
+            shapes.push_back( Circle{ real_dist(rng) } );
+#endif
+         }
+         else if( random_value == 2 ) {
+#if BENCHMARK_WITH_ELLIPSE
+            shapes.push_back( Ellipse{ real_dist(rng), real_dist(rng) } );
+#endif
+         }
+         else if( random_value == 3 ) {
+#if BENCHMARK_WITH_SQUARE
+            shapes.push_back( Square{ real_dist(rng) } );
+#endif
+         }
+         else if( random_value == 4 ) {
+#if BENCHMARK_WITH_RECTANGLE
+            shapes.push_back( Rectangle{ real_dist(rng), real_dist(rng) } );
+#endif
+         }
+         else if( random_value == 5 ) {
+#if BENCHMARK_WITH_PENTAGON
+            shapes.push_back( Pentagon{ real_dist(rng) } );
+#endif
+         }
+         else {
+#if BENCHMARK_WITH_HEXAGON
+            shapes.push_back( Hexagon{ real_dist(rng) } );
+#endif
+         }
+      }
+
+      std::chrono::time_point<std::chrono::high_resolution_clock> start, end;
+      start = std::chrono::high_resolution_clock::now();
+
+      for( size_t s=0UL; s<steps; ++s ) {
+         translate( shapes, Vector2D{ real_dist(rng), real_dist(rng) } );
+      }
+
+      end = std::chrono::high_resolution_clock::now();
+      std::chrono::duration<double> const elapsedTime( end - start );
+      double const seconds( elapsedTime.count() );
+
+      std::cout << " variant_vector solution runtime : " << seconds << "s\n";
+
+      if( !check_ordered( N, seed ) ) {
+         std::cerr << " ordered_variant_vector: inconsistent order index\n";
+         return EXIT_FAILURE;
+      }
+   }
+#endif
+
+#if BENCHMARK_COMPACT_VARIANT_SOLUTION
+   {
+      using namespace compact_variant_solution;
+
+      rng.seed( seed );
+
+      Shapes shapes;
+
+      while( shapes.size() < N )
+      {
+         int const random_value( int_dist(rng) );
+
+         if( random_value == 1 ) {
+#if BENCHMARK_WITH_CIRCLE
+            shapes.push_back( Circle{ real_dist(rng) } );
+#endif
+         }
+         else if( random_value == 2 ) {
+#if BENCHMARK_WITH_ELLIPSE
+            shapes.push_back( Ellipse{ real_dist(rng), real_dist(rng) } );
+#endif
+         }
+         else if( random_value == 3 ) {
+#if BENCHMARK_WITH_SQUARE
+            shapes.push_back( Square{ real_dist(rng) } );
+#endif
+         }
+         else if( random_value == 4 ) {
+#if BENCHMARK_WITH_RECTANGLE
+            shapes.push_back( Rectangle{ real_dist(rng), real_dist(rng) } );
+#endif
+         }
+         else if( random_value == 5 ) {
+#if BENCHMARK_WITH_PENTAGON
+            shapes.push_back( Pentagon{ real_dist(rng) } );
+#endif
+         }
+         else {
+#if BENCHMARK_WITH_HEXAGON
+            shapes.push_back( Hexagon{ real_dist(rng) } );
+#endif
+         }
+      }
+
+      std::chrono::time_point<std::chrono::high_resolution_clock> start, end;
+      start = std::chrono::high_resolution_clock::now();
+
+      for( size_t s=0UL; s<steps; ++s ) {
+         translate( shapes, Vector2D{ real_dist(rng), real_dist(rng) } );
+      }
+
+      end = std::chrono::high_resolution_clock::now();
+      std::chrono::duration<double> const elapsedTime( end - start );
+      double const seconds( elapsedTime.count() );
+
+      std::cout << " Compact variant solution runtime: " << seconds << "s\n";
+
+      // Memory footprint extrapolated to 10M shapes, compared to a padded 'std::vector<std::variant>'
+      constexpr size_t M( 10000000UL );
+      double const compact_bytes( static_cast<double>( shapes.bytes() ) / shapes.size() );
+      double const padded_bytes( sizeof( std::variant<
+#if BENCHMARK_WITH_CIRCLE
+         Circle
+#endif
+#if BENCHMARK_WITH_CIRCLE && BENCHMARK_WITH_ELLIPSE
+         ,Ellipse
+#elif BENCHMARK_WITH_ELLIPSE
+         Ellipse
+#endif
+#if ( BENCHMARK_WITH_CIRCLE || BENCHMARK_WITH_ELLIPSE ) && BENCHMARK_WITH_SQUARE
+         ,Square
+#elif BENCHMARK_WITH_SQUARE
+         Square
+#endif
+#if ( BENCHMARK_WITH_CIRCLE || BENCHMARK_WITH_ELLIPSE || BENCHMARK_WITH_SQUARE ) && BENCHMARK_WITH_RECTANGLE
+         ,Rectangle
+#elif BENCHMARK_WITH_RECTANGLE
+         Rectangle
+#endif
+#if ( BENCHMARK_WITH_CIRCLE || BENCHMARK_WITH_ELLIPSE || BENCHMARK_WITH_SQUARE || BENCHMARK_WITH_RECTANGLE ) && BENCHMARK_WITH_PENTAGON
+         ,Pentagon
+#elif BENCHMARK_WITH_PENTAGON
+         Pentagon
+#endif
+#if ( BENCHMARK_WITH_CIRCLE || BENCHMARK_WITH_ELLIPSE || BENCHMARK_WITH_SQUARE || BENCHMARK_WITH_RECTANGLE || BENCHMARK_WITH_PENTAGON ) && BENCHMARK_WITH_HEXAGON
+         ,Hexagon
+#elif BENCHMARK_WITH_HEXAGON
+         Hexagon
+#endif
+         > ) );
+
+      std::cout << "   Memory for 10M shapes         : " << std::fixed << std::setprecision(1)
+                << compact_bytes*M/1.0E6 << "MB (compact) vs " << padded_bytes*M/1.0E6
+                << "MB (std::variant), " << 100.0*( 1.0 - compact_bytes/padded_bytes ) << "% saved\n"
+                << std::defaultfloat << std::setprecision(6);
+   }
+#endif
+
 #if BENCHMARK_BOOST_VARIANT_SOLUTION
    {
       using namespace boost_variant_solution;